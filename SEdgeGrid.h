@@ -0,0 +1,187 @@
+#pragma once
+
+#include "SMeshTopology.h"
+#include "SSpatialGrid.h"
+#include "SVec3.h"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+// Mesh edges indexed by their midpoints, used to match edges between meshes that no longer share
+// vertex ids. Every query is bounded by a radius so its cost follows the local edge density.
+class SEdgeGrid
+{
+public:
+	SEdgeGrid() {};
+	~SEdgeGrid() {};
+
+	// Cells are sized to the mean edge length
+	void build(const SMeshTopology &topology, const std::vector<SVec3> &points) {
+		unsigned int numEdges = topology.numEdges();
+		m_starts.resize(numEdges);
+		m_ends.resize(numEdges);
+
+		std::vector <double> midpoints(3 * numEdges);
+		double totalLength = 0;
+		for (unsigned int e = 0; e < numEdges; e++) {
+			int vertices[2];
+			topology.getEdgeVertices(e, vertices);
+			m_starts[e] = points[vertices[0]];
+			m_ends[e] = points[vertices[1]];
+
+			SVec3 midpoint = (m_starts[e] + m_ends[e]) * 0.5;
+			midpoints[3 * e] = midpoint.x;
+			midpoints[3 * e + 1] = midpoint.y;
+			midpoints[3 * e + 2] = midpoint.z;
+			totalLength += (m_ends[e] - m_starts[e]).length();
+		}
+
+		m_cellSize = (0 < numEdges && 0 < totalLength) ? totalLength / numEdges : 1.0;
+		m_grid.build(midpoints, m_cellSize);
+	};
+
+	unsigned int numEdges() const {
+		return (unsigned int)m_starts.size();
+	};
+
+	// Edges with their midpoint within radius of the point, sorted by id
+	void query(const SVec3 &point, double radius, std::vector<unsigned int> &edges) const {
+		double position[3] = { point.x, point.y, point.z };
+		m_grid.query(position, radius, edges);
+	};
+
+	// Edges running along the segment: both ends within tolerance of it and less than 45 degrees
+	// off its direction. The segment is swept with bounded queries spaced one cell apart.
+	void querySegment(const SVec3 &start, const SVec3 &end, double tolerance, std::vector<unsigned int> &edges) const {
+		edges.clear();
+
+		SVec3 direction = end - start;
+		double length = direction.length();
+		unsigned int numSteps = std::max(1u, (unsigned int)std::ceil(length / m_cellSize));
+		double radius = 0.5 * length / numSteps + tolerance;
+
+		for (unsigned int i = 0; i <= numSteps; i++) {
+			SVec3 sample = start + direction * ((double)i / numSteps);
+			double position[3] = { sample.x, sample.y, sample.z };
+			m_grid.query(position, radius, [&edges](unsigned int index, double) {
+				edges.push_back(index);
+			});
+		}
+		std::sort(edges.begin(), edges.end());
+		edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+		edges.erase(std::remove_if(edges.begin(), edges.end(), [&](unsigned int edge) {
+			SVec3 edgeDirection = m_ends[edge] - m_starts[edge];
+			double edgeLength = edgeDirection.length();
+			if (edgeLength == 0 || length == 0)
+				return true;
+			if (std::fabs(edgeDirection.dot(direction)) < std::sqrt(0.5) * edgeLength * length)
+				return true;
+			return tolerance < m_starts[edge].distanceToSegment(start, end) || tolerance < m_ends[edge].distanceToSegment(start, end);
+		}), edges.end());
+	};
+
+	// Nearest chain of edges following the segment. Walks topology from the candidate vertex
+	// closest to start, always on to the closest candidate edge that advances along the segment,
+	// until the vertex closest to end is reached. Distances are the farther edge end of each edge.
+	void traceSegment(const SMeshTopology &topology, const SVec3 &start, const SVec3 &end, double tolerance, std::vector<unsigned int> &chain, std::vector<double> &distances) const {
+		chain.clear();
+		distances.clear();
+
+		std::vector <unsigned int> candidates;
+		querySegment(start, end, tolerance, candidates);
+		if (candidates.size() == 0)
+			return;
+
+		int
+			vertex = -1,
+			endVertex = -1;
+		double
+			startDistance = 0,
+			endDistance = 0;
+		SVec3 position;
+		for (auto &edge : candidates)
+			for (unsigned int i = 0; i < 2; i++) {
+				const SVec3 &point = (i == 0) ? m_starts[edge] : m_ends[edge];
+				double
+					toStart = (point - start).length(),
+					toEnd = (point - end).length();
+				if (vertex < 0 || toStart < startDistance) {
+					vertex = topology.edgeVertex(edge, i);
+					startDistance = toStart;
+					position = point;
+				}
+				if (endVertex < 0 || toEnd < endDistance) {
+					endVertex = topology.edgeVertex(edge, i);
+					endDistance = toEnd;
+				}
+			}
+
+		SVec3 direction = end - start;
+		double squaredLength = direction.squaredLength();
+		auto parameter = [&](const SVec3 &point) {
+			return (point - start).dot(direction) / squaredLength;
+		};
+
+		while (vertex != endVertex && chain.size() < candidates.size()) {
+			int next = -1;
+			double nextDistance = 0;
+			for (unsigned int e = 0; e < topology.numConnectedEdges(vertex); e++) {
+				unsigned int edge = topology.connectedEdges(vertex)[e];
+				if (!std::binary_search(candidates.begin(), candidates.end(), edge))
+					continue;
+
+				const SVec3 &other = (topology.edgeVertex(edge, 0) == vertex) ? m_ends[edge] : m_starts[edge];
+				if (parameter(other) <= parameter(position))
+					continue;
+
+				double distance = std::max(m_starts[edge].distanceToSegment(start, end), m_ends[edge].distanceToSegment(start, end));
+				if (next < 0 || distance < nextDistance) {
+					next = edge;
+					nextDistance = distance;
+				}
+			}
+			if (next < 0)
+				break;
+
+			chain.push_back(next);
+			distances.push_back(nextDistance);
+			vertex = topology.oppositeVertex(vertex, next);
+			position = (topology.edgeVertex(next, 0) == vertex) ? m_starts[next] : m_ends[next];
+		}
+	};
+
+	// Chains of every segment, a target edge claimed by several segments stays with the closest
+	// one, ties go to the lower segment
+	void matchSegments(const SMeshTopology &topology, const std::vector<SVec3> &starts, const std::vector<SVec3> &ends, double tolerance, std::vector<std::vector<unsigned int>> &chains) const {
+		unsigned int numSegments = (unsigned int)std::min(starts.size(), ends.size());
+		chains.assign(numSegments, std::vector<unsigned int>());
+
+		std::vector <std::vector<double>> distances(numSegments);
+		std::vector <int> owners(numEdges(), -1);
+		std::vector <double> ownerDistances(numEdges(), 0);
+		for (unsigned int s = 0; s < numSegments; s++) {
+			traceSegment(topology, starts[s], ends[s], tolerance, chains[s], distances[s]);
+			for (unsigned int i = 0; i < chains[s].size(); i++) {
+				unsigned int edge = chains[s][i];
+				if (owners[edge] < 0 || distances[s][i] < ownerDistances[edge]) {
+					owners[edge] = s;
+					ownerDistances[edge] = distances[s][i];
+				}
+			}
+		}
+
+		for (unsigned int s = 0; s < numSegments; s++)
+			chains[s].erase(std::remove_if(chains[s].begin(), chains[s].end(), [&](unsigned int edge) {
+				return owners[edge] != (int)s;
+			}), chains[s].end());
+	};
+
+private:
+	double m_cellSize = 1.0;
+	std::vector <SVec3>
+		m_starts,
+		m_ends;
+	SSpatialGrid m_grid;
+};
\ No newline at end of file
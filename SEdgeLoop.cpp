@@ -1,5 +1,7 @@
 #include "SEdgeLoop.h"
 
+#include <algorithm>
+#include <iterator>
 #include <set>
 
 	SEdgeLoop::SEdgeLoop(MObject *meshPtr) {
@@ -8,16 +10,28 @@
 
 	SEdgeLoop::SEdgeLoop(const SEdgeLoop &edgeLoop) {
 		m_meshPtr = edgeLoop.m_meshPtr;
-		m_ordered = edgeLoop.m_ordered;
-		m_flipped = edgeLoop.m_flipped;
+		m_ranges = edgeLoop.m_ranges;
+		m_members = edgeLoop.m_members;
+		m_scaledMembers = edgeLoop.m_scaledMembers;
+		m_numEdges = edgeLoop.m_numEdges;
 		m_isReversed = edgeLoop.m_isReversed;
+		m_isCacheValid = edgeLoop.m_isCacheValid;
+		m_edgeVertices = edgeLoop.m_edgeVertices;
+		m_points = edgeLoop.m_points;
+		m_arcLengths = edgeLoop.m_arcLengths;
 	};
 
 	SEdgeLoop& SEdgeLoop::operator=(const SEdgeLoop& edgeLoop) {
 		m_meshPtr = edgeLoop.m_meshPtr;
-		m_ordered = edgeLoop.m_ordered;
-		m_flipped = edgeLoop.m_flipped;
+		m_ranges = edgeLoop.m_ranges;
+		m_members = edgeLoop.m_members;
+		m_scaledMembers = edgeLoop.m_scaledMembers;
+		m_numEdges = edgeLoop.m_numEdges;
 		m_isReversed = edgeLoop.m_isReversed;
+		m_isCacheValid = edgeLoop.m_isCacheValid;
+		m_edgeVertices = edgeLoop.m_edgeVertices;
+		m_points = edgeLoop.m_points;
+		m_arcLengths = edgeLoop.m_arcLengths;
 
 		return *this;
 	}
@@ -27,6 +41,62 @@
 
 	void SEdgeLoop::setMeshPtr(MObject *meshPtr) {
 		m_meshPtr = meshPtr;
+		invalidate();
+	}
+
+	// Must be called when the mesh points change underneath the loop
+	void SEdgeLoop::invalidate() {
+		m_isCacheValid = false;
+	}
+
+	MStatus SEdgeLoop::updateCache() {
+		MStatus status;
+
+		if (m_isCacheValid)
+			return MS::kSuccess;
+		if (m_meshPtr == NULL)
+			return MS::kFailure;
+
+		MFnMesh fnMesh(*m_meshPtr, &status);
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+
+		const float *rawPoints = fnMesh.getRawPoints(&status);
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+
+		unsigned int
+			numLoopEdges = numEdges(),
+			numMeshEdges = fnMesh.numEdges();
+
+		m_edgeVertices.resize(2 * numLoopEdges);
+		unsigned int i = 0;
+		for (auto &range : m_ranges)
+			for (unsigned int r = 0; r < range.count; r++, i++) {
+				unsigned int edge = range.edge(r);
+				if (numMeshEdges <= edge)
+					return MS::kInvalidParameter;
+
+				int2 vertices;
+				status = fnMesh.getEdgeVertices(edge, vertices);
+				CHECK_MSTATUS_AND_RETURN_IT(status);
+				if (range.flipped)
+					flip(vertices);
+
+				m_edgeVertices[2 * i] = vertices[0];
+				m_edgeVertices[2 * i + 1] = vertices[1];
+			}
+
+		unsigned int numPoints = (0 < numLoopEdges) ? numLoopEdges + 1 : 0;
+		m_points.setLength(numPoints);
+		m_arcLengths.resize(numPoints);
+		for (i = 0; i < numPoints; i++) {
+			const float *rawPoint = rawPoints + 3 * ((i == 0) ? m_edgeVertices[0] : m_edgeVertices[2 * i - 1]);
+			m_points[i] = MPoint(rawPoint[0], rawPoint[1], rawPoint[2]);
+			m_arcLengths[i] = (i == 0) ? 0.0 : m_arcLengths[i - 1] + m_points[i].distanceTo(m_points[i - 1]);
+		}
+
+		m_isCacheValid = true;
+
+		return MS::kSuccess;
 	}
 
 	MStatus SEdgeLoop::add(const unsigned int edge) {
@@ -35,7 +105,7 @@
 		if (m_meshPtr == NULL)
 			return MS::kFailure;
 
-		if (m_ordered.size() == 0) {
+		if (numEdges() == 0) {
 			pushBack(edge);
 			return MS::kSuccess;
 		}
@@ -72,68 +142,238 @@
 	}
 
 	MStatus SEdgeLoop::getLength(double &loopLength) {
-		MStatus status;
-		
-		MItMeshEdge itEdge(*m_meshPtr, &status);
+		MStatus status = updateCache();
 		CHECK_MSTATUS_AND_RETURN_IT(status);
 
-		loopLength = 0;
-		for (auto &edge : m_ordered) {
-			int previousVtx;
-			status = itEdge.setIndex(edge, previousVtx);
-			CHECK_MSTATUS_AND_RETURN_IT(status);
+		loopLength = (0 < m_arcLengths.size()) ? m_arcLengths.back() : 0.0;
 
-			double edgeLength;
-			status = itEdge.getLength(edgeLength);
-			CHECK_MSTATUS_AND_RETURN_IT(status);
+		return MS::kSuccess;
+	}
 
-			loopLength += edgeLength;
-		}
+	// Segment the arc length falls on, found by bisecting the cumulative lengths
+	unsigned int SEdgeLoop::segmentAtLength(const double length) const {
+		auto upper = std::upper_bound(m_arcLengths.begin(), m_arcLengths.end(), length);
+		unsigned int segment = (upper == m_arcLengths.begin()) ? 0 : (unsigned int)(upper - m_arcLengths.begin()) - 1;
+		return std::min(segment, numEdges() - 1);
+	}
+
+	// Parameter runs from 0 at the loop start to numEdges() at its end, the integer part is the edge index
+	MStatus SEdgeLoop::getParameterAtLength(const double length, double &parameter) {
+		MStatus status = updateCache();
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+
+		if (numEdges() == 0)
+			return MS::kFailure;
+
+		double clamped = std::max(0.0, std::min(length, m_arcLengths.back()));
+		unsigned int segment = segmentAtLength(clamped);
+		double segmentLength = m_arcLengths[segment + 1] - m_arcLengths[segment];
+
+		parameter = segment;
+		if (0 < segmentLength)
+			parameter += (clamped - m_arcLengths[segment]) / segmentLength;
 
 		return MS::kSuccess;
 	}
 
+	MStatus SEdgeLoop::getPointAtLength(const double length, MPoint &point) {
+		MStatus status;
+
+		double parameter;
+		status = getParameterAtLength(length, parameter);
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+
+		unsigned int segment = std::min((unsigned int)parameter, numEdges() - 1);
+		double fraction = parameter - segment;
+		point = m_points[segment] + (m_points[segment + 1] - m_points[segment]) * fraction;
+
+		return MS::kSuccess;
+	}
+
+	// Extends the front range when the edge continues it, otherwise opens a new one
 	bool SEdgeLoop::pushFront(const unsigned int edge, const bool flip) {
 		if (contains(edge))
 			return false;
+		m_members.insert(edge);
+
+		SEdgeRange *front = (0 < m_ranges.size()) ? &m_ranges.front() : NULL;
+		if (front != NULL && front->flipped == flip && front->count == 1 && (edge + 1 == front->first || edge == front->first + 1))
+			front->step = (edge < front->first) ? 1 : -1;
 
-		m_ordered.push_front(edge);
-		m_flipped.push_front(flip);
+		if (front != NULL && front->flipped == flip && (long long)front->first - front->step == (long long)edge) {
+			front->first = edge;
+			front->count++;
+			front->offset--;
+		}
+		else {
+			SEdgeRange range;
+			range.first = edge;
+			range.count = 1;
+			range.flipped = flip;
+			range.offset = (front != NULL) ? front->offset - 1 : 0;
+			m_ranges.push_front(range);
+		}
+
+		m_numEdges++;
+		invalidate();
 		return true;
 	}
 
 	bool SEdgeLoop::pushBack(const unsigned int edge, const bool flip) {
 		if (contains(edge))
 			return false;
+		m_members.insert(edge);
+
+		SEdgeRange *back = (0 < m_ranges.size()) ? &m_ranges.back() : NULL;
+		if (back != NULL && back->flipped == flip && back->count == 1 && (edge + 1 == back->first || edge == back->first + 1))
+			back->step = (back->first < edge) ? 1 : -1;
+
+		if (back != NULL && back->flipped == flip && (long long)back->first + (long long)back->step * back->count == (long long)edge)
+			back->count++;
+		else {
+			SEdgeRange range;
+			range.first = edge;
+			range.count = 1;
+			range.flipped = flip;
+			range.offset = (back != NULL) ? back->offset + back->count : 0;
+			m_ranges.push_back(range);
+		}
 
-		m_ordered.push_back(edge);
-		m_flipped.push_back(flip);
+		m_numEdges++;
+		invalidate();
 		return true;
 	}
 
 	bool SEdgeLoop::contains(const unsigned int edge) const {
-		if (std::find(m_ordered.begin(), m_ordered.end(), edge) == m_ordered.end())
+		if (m_members.count(edge) != 0)
+			return true;
+		if (m_scaledMembers.size() == 0)
 			return false;
-		return true;
+
+		auto interval = m_scaledMembers.upper_bound(edge);
+		if (interval == m_scaledMembers.begin())
+			return false;
+		--interval;
+		return edge <= interval->second;
+	}
+
+	// Adds [first, last] to the scaled intervals, merging touching ones
+	void SEdgeLoop::insertScaledMembers(unsigned int first, unsigned int last) {
+		auto interval = m_scaledMembers.upper_bound(first);
+		if (interval != m_scaledMembers.begin() && first <= std::prev(interval)->second + 1) {
+			--interval;
+			first = interval->first;
+		}
+		while (interval != m_scaledMembers.end() && interval->first <= last + 1) {
+			last = std::max(last, interval->second);
+			interval = m_scaledMembers.erase(interval);
+		}
+		m_scaledMembers.emplace_hint(interval, first, last);
+	}
+
+	// Renumbers the loop in place, orientation is kept
+	void SEdgeLoop::setEdges(const std::vector<unsigned int> &edges) {
+		std::vector <bool> flipped(numEdges());
+		for (unsigned int i = 0; i < flipped.size(); i++)
+			flipped[i] = isFlipped(i);
+
+		bool isReversed = m_isReversed;
+		clear();
+		m_isReversed = isReversed;
+
+		for (unsigned int i = 0; i < flipped.size() && i < edges.size(); i++)
+			pushBack(edges[i], flipped[i]);
+	}
+
+	// Every edge becomes multiplier consecutive edges, as numbered by subdivision. Ranges that
+	// run along their orientation stay a single range, others are split per edge.
+	void SEdgeLoop::scale(const unsigned int multiplier) {
+		if (multiplier < 2)
+			return;
+
+		std::deque <SEdgeRange> ranges;
+		ranges.swap(m_ranges);
+		m_members.clear();
+		m_scaledMembers.clear();
+
+		long long offset = 0;
+		for (auto &range : ranges) {
+			bool isAligned = (range.count == 1 || range.step == (range.flipped ? -1 : 1));
+			unsigned int numParts = isAligned ? 1 : range.count;
+
+			for (unsigned int p = 0; p < numParts; p++) {
+				SEdgeRange scaled;
+				scaled.first = range.edge(p) * multiplier + (range.flipped ? multiplier - 1 : 0);
+				scaled.count = (isAligned ? range.count : 1) * multiplier;
+				scaled.step = range.flipped ? -1 : 1;
+				scaled.flipped = range.flipped;
+				scaled.offset = offset;
+				offset += scaled.count;
+
+				unsigned int last = scaled.edge(scaled.count - 1);
+				insertScaledMembers(std::min(scaled.first, last), std::max(scaled.first, last));
+				m_ranges.push_back(scaled);
+			}
+		}
+
+		m_numEdges *= multiplier;
+		invalidate();
+	}
+
+	void SEdgeLoop::clear() {
+		m_ranges.clear();
+		m_members.clear();
+		m_scaledMembers.clear();
+		m_numEdges = 0;
+		m_isReversed = false;
+		invalidate();
 	}
 
 	unsigned int SEdgeLoop::numEdges() const {
-		return (int)m_ordered.size();
+		return m_numEdges;
+	}
+
+	// Range holding the loop index, found by bisecting the range offsets
+	unsigned int SEdgeLoop::rangeAt(const unsigned int index) const {
+		long long position = m_ranges.front().offset + index;
+		auto range = std::upper_bound(m_ranges.begin(), m_ranges.end(), position, [](long long position, const SEdgeRange &range) {
+			return position < range.offset;
+		});
+		return (unsigned int)(range - m_ranges.begin()) - 1;
+	}
+
+	unsigned int SEdgeLoop::operator[](const unsigned int index) const {
+		const SEdgeRange &range = m_ranges[rangeAt(index)];
+		return range.edge((unsigned int)(m_ranges.front().offset + index - range.offset));
+	}
+
+	unsigned int SEdgeLoop::numRanges() const {
+		return (unsigned int)m_ranges.size();
 	}
 
-	unsigned int &SEdgeLoop::operator[](const unsigned int index) {
-		return m_ordered[index];
+	const SEdgeRange &SEdgeLoop::range(const unsigned int index) const {
+		return m_ranges[index];
 	}
 
 	void SEdgeLoop::get(MIntArray &edges) {
-		for (auto &edgeId : m_ordered)
-			edges.append(edgeId);
+		for (auto &range : m_ranges)
+			for (unsigned int r = 0; r < range.count; r++)
+				edges.append(range.edge(r));
+	}
+
+	void SEdgeLoop::get(std::vector<unsigned int> &edges) const {
+		edges.resize(numEdges());
+		unsigned int i = 0;
+		for (auto &range : m_ranges)
+			for (unsigned int r = 0; r < range.count; r++)
+				edges[i++] = range.edge(r);
 	}
 
 	void SEdgeLoop::print() {
 		cout << "edge start ---------------" << endl;
-		for (auto &edgeId : m_ordered)
-			cout << edgeId << endl;
+		for (auto &range : m_ranges)
+			for (unsigned int r = 0; r < range.count; r++)
+				cout << range.edge(r) << endl;
 	}
 
 	void SEdgeLoop::flip(int2 &vertices) {
@@ -145,48 +385,44 @@
 	MStatus SEdgeLoop::getEdgeVertices(const unsigned int index, int2 &vertices, bool &flipped) {
 		MStatus status;
 
-		if (m_meshPtr == NULL)
-			return MS::kFailure;
-
-		MFnMesh fnMesh(*m_meshPtr, &status);
-		CHECK_MSTATUS_AND_RETURN_IT(status);
-
-		if (index > (numEdges() - 1))
-			return MS::kInvalidParameter;
-		if (m_ordered[index] > (unsigned int)(fnMesh.numEdges() - 1))
+		if (numEdges() <= index)
 			return MS::kInvalidParameter;
 
-		status = fnMesh.getEdgeVertices(m_ordered[index], vertices);
+		status = updateCache();
 		CHECK_MSTATUS_AND_RETURN_IT(status);
 
-		flipped = m_flipped[index];
-		if (flipped)
-			flip(vertices);
+		vertices[0] = m_edgeVertices[2 * index];
+		vertices[1] = m_edgeVertices[2 * index + 1];
+		flipped = isFlipped(index);
 
 		return MS::kSuccess;
 	}
 
 	MStatus SEdgeLoop::getVertices(MIntArray& vertices) {
-		MStatus status;
+		MStatus status = updateCache();
+		CHECK_MSTATUS_AND_RETURN_IT(status);
 
 		vertices.clear();
+		if (numEdges() == 0)
+			return MS::kSuccess;
 
-		for (unsigned int i = 0; i < numEdges(); i++) {
-			int2 edgeVertices; bool flipped;
-			status = getEdgeVertices(i, edgeVertices, flipped);
-			CHECK_MSTATUS_AND_RETURN_IT(status);
-			if(i==0)
-				vertices.append(edgeVertices[0]);
-			vertices.append(edgeVertices[1]);
-		}
+		vertices.setLength(numEdges() + 1);
+		vertices[0] = m_edgeVertices[0];
+		for (unsigned int i = 0; i < numEdges(); i++)
+			vertices[i + 1] = m_edgeVertices[2 * i + 1];
 
 		return MS::kSuccess;
 	}
 
+	// Object space points come from the cache, other spaces are looked up per loop vertex
 	MStatus SEdgeLoop::getPoints(MPointArray& points, MSpace::Space space) {
-		MStatus status;
+		MStatus status = updateCache();
+		CHECK_MSTATUS_AND_RETURN_IT(status);
 
-		points.clear();
+		if (space == MSpace::kObject) {
+			points = m_points;
+			return MS::kSuccess;
+		}
 
 		MIntArray vertices;
 		status = getVertices(vertices);
@@ -195,18 +431,17 @@
 		MFnMesh fnMesh(*m_meshPtr, &status);
 		CHECK_MSTATUS_AND_RETURN_IT(status);
 
-		MPointArray meshPoints;
-		status = fnMesh.getPoints(meshPoints, space);
-		CHECK_MSTATUS_AND_RETURN_IT(status);
-
-		for (unsigned int i = 0; i < vertices.length(); i++)
-			points.append(meshPoints[vertices[i]]);
+		points.setLength(vertices.length());
+		for (unsigned int i = 0; i < vertices.length(); i++) {
+			status = fnMesh.getPoint(vertices[i], points[i], space);
+			CHECK_MSTATUS_AND_RETURN_IT(status);
+		}
 
 		return MS::kSuccess;
 	}
 
-	bool SEdgeLoop::isFlipped(const unsigned int index) {
-		return m_flipped[index];
+	bool SEdgeLoop::isFlipped(const unsigned int index) const {
+		return m_ranges[rangeAt(index)].flipped;
 	}
 
 	bool SEdgeLoop::isClosed() {
@@ -229,11 +464,17 @@
 	}
 
 	void SEdgeLoop::reverse() {
-		std::reverse(m_ordered.begin(), m_ordered.end());
-		std::reverse(m_flipped.begin(), m_flipped.end());
-		for (auto &flipped : m_flipped)
-			flipped = (flipped) ? false : true;
+		std::reverse(m_ranges.begin(), m_ranges.end());
+		long long offset = 0;
+		for (auto &range : m_ranges) {
+			range.first = range.edge(range.count - 1);
+			range.step = -range.step;
+			range.flipped = (range.flipped) ? false : true;
+			range.offset = offset;
+			offset += range.count;
+		}
 		m_isReversed = (m_isReversed) ? false : true;
+		invalidate();
 	}
 
 	bool SEdgeLoop::isReversed() {
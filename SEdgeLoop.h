@@ -8,6 +8,25 @@
 #include <maya\MPointArray.h>
 
 #include <deque>
+#include <vector>
+#include <map>
+#include <unordered_set>
+
+// Run of consecutive loop edges whose ids change by a constant step and share an orientation.
+// Offset is the position of the first edge in the loop, it goes negative when pushing to the front.
+struct SEdgeRange
+{
+	unsigned int
+		first = 0,
+		count = 0;
+	int step = 1;
+	bool flipped = false;
+	long long offset = 0;
+
+	unsigned int edge(const unsigned int index) const {
+		return (unsigned int)((long long)first + (long long)step * index);
+	};
+};
 
 class SEdgeLoop {
 public:
@@ -22,31 +41,58 @@ public:
 	bool pushFront(const unsigned int edge, const bool flip = false);
 	bool pushBack(const unsigned int edge, const bool flip = false);
 	bool contains(const unsigned int edge) const;
+	void setEdges(const std::vector<unsigned int> &edges);
+	void scale(const unsigned int multiplier);
+	void clear();
 
 	MStatus getLength(double &loopLength);
+	MStatus getParameterAtLength(const double length, double &parameter);
+	MStatus getPointAtLength(const double length, MPoint &point);
 	unsigned int numEdges() const;
-	unsigned int &operator[](const unsigned int index);
+	unsigned int operator[](const unsigned int index) const;
+	unsigned int numRanges() const;
+	const SEdgeRange &range(const unsigned int index) const;
 	void get(MIntArray &edges);
+	void get(std::vector<unsigned int> &edges) const;
 	MStatus getVertices(MIntArray &vertices);
 	MStatus getPoints(MPointArray &points, MSpace::Space space = MSpace::kObject);
 
 	MStatus getEdgeVertices(const unsigned int index, int2 &vertices, bool &flipped);
 
 	static void flip(int2 &vertices);
-	bool isFlipped(const unsigned int index);
+	bool isFlipped(const unsigned int index) const;
 
 	bool isClosed();
 	void endVertices(int2 &vertices);
 
 	void print();
 
+	void invalidate();
+
 	void reverse();
 	bool isReversed();
 	void setReversed(bool reversed);
 
 protected:
 	MObject *m_meshPtr = NULL;
-	std::deque <unsigned int> m_ordered;
-	std::deque <bool> m_flipped;
+
+	MStatus updateCache();
+	unsigned int segmentAtLength(const double length) const;
+	unsigned int rangeAt(const unsigned int index) const;
+	void insertScaledMembers(unsigned int first, unsigned int last);
+
+	// Loop edges are stored as ranges. Pushed edges are hashed for membership, ranges made by
+	// scale() are kept as disjoint [first, last] id intervals instead of one entry per edge.
+	std::deque <SEdgeRange> m_ranges;
+	std::unordered_set <unsigned int> m_members;
+	std::map <unsigned int, unsigned int> m_scaledMembers;
+	unsigned int m_numEdges = 0;
 	bool m_isReversed = false;
+
+	// Oriented edge vertices, object space points of the vertex sequence and cumulative arc
+	// length at every point. Rebuilt on first use after an edit.
+	bool m_isCacheValid = false;
+	std::vector <int> m_edgeVertices;
+	MPointArray m_points;
+	std::vector <double> m_arcLengths;
 };
\ No newline at end of file
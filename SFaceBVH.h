@@ -0,0 +1,170 @@
+#pragma once
+
+#include "SMeshTopology.h"
+#include "SVec3.h"
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+
+// Bounding volume hierarchy over the faces of a mesh, used to find the faces a plane passes
+// through without visiting the rest. Nodes are stored flat, the two children of an inner node
+// next to each other. Leaves own a range of the face order.
+class SFaceBVH
+{
+public:
+	SFaceBVH() {};
+	~SFaceBVH() {};
+
+	// Faces are split at the centroid median of the longest axis until a leaf holds leafSize faces
+	void build(const SMeshTopology &topology, const std::vector<SVec3> &points, unsigned int leafSize = 8) {
+		clear();
+
+		unsigned int numFaces = topology.numFaces();
+		if (numFaces == 0)
+			return;
+		if (leafSize == 0)
+			leafSize = 1;
+
+		m_faceMin.resize(numFaces);
+		m_faceMax.resize(numFaces);
+		m_faces.resize(numFaces);
+		std::vector <SVec3> centroids(numFaces);
+		for (unsigned int f = 0; f < numFaces; f++) {
+			const int *vertices = topology.faceVertices(f);
+			m_faceMin[f] = m_faceMax[f] = points[vertices[0]];
+			for (unsigned int i = 1; i < topology.faceCount(f); i++)
+				for (unsigned int axis = 0; axis < 3; axis++) {
+					m_faceMin[f][axis] = std::min(m_faceMin[f][axis], points[vertices[i]][axis]);
+					m_faceMax[f][axis] = std::max(m_faceMax[f][axis], points[vertices[i]][axis]);
+				}
+			centroids[f] = (m_faceMin[f] + m_faceMax[f]) * 0.5;
+			m_faces[f] = f;
+		}
+
+		// Nodes are split from an explicit stack
+		m_nodes.push_back(Node());
+		m_nodes[0].count = numFaces;
+		std::vector <unsigned int> stack(1, 0u);
+		while (0 < stack.size()) {
+			unsigned int index = stack.back();
+			stack.pop_back();
+
+			unsigned int
+				first = m_nodes[index].first,
+				count = m_nodes[index].count;
+
+			SVec3 centroidMin = centroids[m_faces[first]], centroidMax = centroidMin;
+			SVec3 nodeMin = m_faceMin[m_faces[first]], nodeMax = m_faceMax[m_faces[first]];
+			for (unsigned int i = first + 1; i < first + count; i++) {
+				unsigned int face = m_faces[i];
+				for (unsigned int axis = 0; axis < 3; axis++) {
+					nodeMin[axis] = std::min(nodeMin[axis], m_faceMin[face][axis]);
+					nodeMax[axis] = std::max(nodeMax[axis], m_faceMax[face][axis]);
+					centroidMin[axis] = std::min(centroidMin[axis], centroids[face][axis]);
+					centroidMax[axis] = std::max(centroidMax[axis], centroids[face][axis]);
+				}
+			}
+			m_nodes[index].min = nodeMin;
+			m_nodes[index].max = nodeMax;
+
+			if (count <= leafSize)
+				continue;
+
+			unsigned int axis = 0;
+			SVec3 extent = centroidMax - centroidMin;
+			if (extent[axis] < extent[1])
+				axis = 1;
+			if (extent[axis] < extent[2])
+				axis = 2;
+
+			unsigned int middle = first + count / 2;
+			std::nth_element(m_faces.begin() + first, m_faces.begin() + middle, m_faces.begin() + first + count, [&](unsigned int a, unsigned int b) {
+				return centroids[a][axis] < centroids[b][axis];
+			});
+
+			// Turned into an inner node, the children take over its face range
+			unsigned int child = (unsigned int)m_nodes.size();
+			m_nodes[index].count = 0;
+			m_nodes[index].child = child;
+			m_nodes.resize(child + 2);
+			m_nodes[child].first = first;
+			m_nodes[child].count = middle - first;
+			m_nodes[child + 1].first = middle;
+			m_nodes[child + 1].count = first + count - middle;
+
+			stack.push_back(child);
+			stack.push_back(child + 1);
+		}
+	};
+
+	void clear() {
+		m_nodes.clear();
+		m_faces.clear();
+		m_faceMin.clear();
+		m_faceMax.clear();
+	};
+
+	bool isNull() const {
+		return m_nodes.size() == 0;
+	};
+
+	unsigned int numFaces() const {
+		return (unsigned int)m_faces.size();
+	};
+
+	// Faces whose bounding box touches the plane, in ascending order. Distances are evaluated
+	// like SMeshSection::signedDistances, so a face with a vertex on the plane is never missed.
+	void planeFaces(const SVec3 &origin, const SVec3 &normal, std::vector<unsigned int> &faces) const {
+		faces.clear();
+		if (isNull())
+			return;
+
+		double d = normal.dot(origin);
+		std::vector <unsigned int> stack(1, 0u);
+		while (0 < stack.size()) {
+			const Node &node = m_nodes[stack.back()];
+			stack.pop_back();
+
+			if (!touchesPlane(node.min, node.max, normal, d))
+				continue;
+
+			if (node.count == 0) {
+				stack.push_back(node.child);
+				stack.push_back(node.child + 1);
+				continue;
+			}
+
+			for (unsigned int i = node.first; i < node.first + node.count; i++)
+				if (touchesPlane(m_faceMin[m_faces[i]], m_faceMax[m_faces[i]], normal, d))
+					faces.push_back(m_faces[i]);
+		}
+
+		std::sort(faces.begin(), faces.end());
+	};
+
+private:
+	struct Node {
+		SVec3 min, max;
+		unsigned int first = 0;
+		unsigned int count = 0;
+		unsigned int child = 0;
+	};
+
+	std::vector <Node> m_nodes;
+	std::vector <unsigned int> m_faces;
+	std::vector <SVec3>
+		m_faceMin,
+		m_faceMax;
+
+	// Nearest and farthest corner along the normal. Rounding is monotonic, so the corner distances
+	// bound the distances of every point inside, a small margin covers contracted arithmetic.
+	static bool touchesPlane(const SVec3 &min, const SVec3 &max, const SVec3 &normal, double d) {
+		double
+			nearest = normal.x * ((0 < normal.x) ? min.x : max.x) + normal.y * ((0 < normal.y) ? min.y : max.y) + normal.z * ((0 < normal.z) ? min.z : max.z) - d,
+			farthest = normal.x * ((0 < normal.x) ? max.x : min.x) + normal.y * ((0 < normal.y) ? max.y : min.y) + normal.z * ((0 < normal.z) ? max.z : min.z) - d,
+			margin = 1e-12 * (std::fabs(nearest) + std::fabs(farthest) + std::fabs(d));
+		return nearest <= margin && -margin <= farthest;
+	};
+};
\ No newline at end of file
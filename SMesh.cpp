@@ -1,7 +1,12 @@
 #include "SMesh.h"
+#include "SParallel.h"
+#include "SUnionFind.h"
+#include "SSpatialGrid.h"
 
 #include <maya\MDagPath.h>
 
+#include <iterator>
+
 SMesh::SMesh(){};
 
 SMesh::~SMesh(){}
@@ -13,8 +18,9 @@ SMesh::SMesh(MObject &obj, MStatus *ref){
 	m_mesh = obj;
 
 	MFnMesh fnMesh(m_mesh);
-	for (int v = 0; v < fnMesh.numVertices(); v++)
-		m_vtxMap[v] = v;
+	m_vtxMap.resize(fnMesh.numVertices());
+	std::iota(m_vtxMap.begin(), m_vtxMap.end(), 0);
+	m_vtxSplitValence.assign(fnMesh.numVertices(), 0);
 };
 
 SMesh::SMesh(const SMesh &mesh){
@@ -39,6 +45,16 @@ void SMesh::copyAttributes(const SMesh& mesh) {
 	m_vtxMap = mesh.m_vtxMap;
 	m_vtxSplitValence = mesh.m_vtxSplitValence;
 	m_activeLoops = mesh.m_activeLoops;
+	m_topology = mesh.m_topology;
+	m_isTopologyDirty = mesh.m_isTopologyDirty;
+	m_buffer = mesh.m_buffer;
+	m_isEditing = mesh.m_isEditing;
+}
+
+// Vertices added without a source vertex map to vertex 0
+void SMesh::resizeVertexMaps(unsigned int numVertices) {
+	m_vtxMap.resize(numVertices, 0);
+	m_vtxSplitValence.resize(numVertices, 0);
 }
 
 void SMesh::updateMeshPointers() {
@@ -54,6 +70,116 @@ bool SMesh::isNull() const {
 	return m_mesh.isNull();
 }
 
+const SMeshTopology &SMesh::topology(MStatus *ref) {
+	MStatus status;
+
+	// While editing the buffer is the source of truth
+	if (m_isEditing) {
+		const SMeshTopology &bufferTopology = m_buffer.topology();
+		if (ref != NULL)
+			*ref = bufferTopology.isNull() ? MS::kFailure : MS::kSuccess;
+		return bufferTopology;
+	}
+
+	// Guard against the mesh being swapped or edited behind our back,
+	// counts alone miss a rewire that keeps them equal
+	if (!m_isTopologyDirty) {
+		unsigned long long hash;
+		status = getTopologyHash(m_mesh, hash);
+		if (status == MS::kSuccess && hash == m_topology.hash()) {
+			if (ref != NULL)
+				*ref = MS::kSuccess;
+			return m_topology;
+		}
+	}
+
+	status = getTopology(m_mesh, m_topology);
+	m_isTopologyDirty = (status != MS::kSuccess);
+
+	if (ref != NULL)
+		*ref = status;
+	return m_topology;
+}
+
+void SMesh::invalidateTopology() {
+	m_isTopologyDirty = true;
+}
+
+MStatus SMesh::beginEdit() {
+	MStatus status;
+
+	if (m_isEditing)
+		return MS::kFailure;
+
+	// Make sure the cached topology describes the mesh before the buffer takes over
+	topology(&status);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+
+	status = SMeshAdapter::load(m_mesh, m_buffer);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+	m_buffer.setTopology(m_topology);
+	SMeshAdapter::toVec3Array(m_normals, m_buffer.normals);
+
+	m_isEditing = true;
+
+	return MS::kSuccess;
+}
+
+MStatus SMesh::commitEdit() {
+	MStatus status;
+
+	if (!m_isEditing)
+		return MS::kFailure;
+
+	status = SMeshAdapter::commit(m_buffer, m_mesh);
+	if (status != MS::kSuccess) {
+		cancelEdit();
+		return status;
+	}
+
+	if (m_buffer.isTopologyModified) {
+		invalidateTopology();
+		resizeVertexMaps(m_buffer.numVertices());
+	}
+	if (m_buffer.areNormalsModified)
+		SMeshAdapter::toVectorArray(m_buffer.normals, m_normals);
+	if (m_buffer.isModified())
+		for (auto &loop : m_activeLoops)
+			loop.invalidate();
+
+	m_buffer.clear();
+	m_isEditing = false;
+
+	return MS::kSuccess;
+}
+
+void SMesh::cancelEdit() {
+	m_buffer.clear();
+	m_isEditing = false;
+	invalidateTopology();
+}
+
+bool SMesh::isEditing() const {
+	return m_isEditing;
+}
+
+// Closes an edit that was opened by a single operation
+MStatus SMesh::endEdit(bool isImplicit, MStatus status) {
+	if (!isImplicit)
+		return status;
+
+	if (status != MS::kSuccess) {
+		cancelEdit();
+		return status;
+	}
+
+	return commitEdit();
+}
+
+MStatus SMesh::getTopology(const MObject &mesh, SMeshTopology &topology) {
+	return SMeshAdapter::getTopology(mesh, topology);
+}
+
 bool SMesh::isEquivalent(const MObject& firstMesh, const MObject& secondMesh, MStatus *ref) {
 	if (firstMesh.apiType() != MFn::kMeshData || secondMesh.apiType() != MFn::kMeshData) {
 		*ref = MS::kInvalidParameter;
@@ -87,9 +213,75 @@ bool SMesh::isEquivalent(const MObject& firstMesh, const MObject& secondMesh, MS
 	return true;
 }
 
+// Meshes with different fingerprints differ, equal fingerprints are trusted unless indices are compared
+bool SMesh::isEquivalent(SMesh& mesh, bool compareIndices, MStatus *ref) {
+	MStatus status;
+
+	const SMeshTopology &first = topology(&status);
+	if (ref != NULL)
+		*ref = status;
+	if (status != MS::kSuccess)
+		return false;
+
+	const SMeshTopology &second = mesh.topology(&status);
+	if (ref != NULL)
+		*ref = status;
+	if (status != MS::kSuccess)
+		return false;
+
+	if (first.hash() != second.hash() ||
+		first.numVertices() != second.numVertices() ||
+		first.numEdges() != second.numEdges() ||
+		first.numFaces() != second.numFaces() ||
+		first.numFaceVertices() != second.numFaceVertices())
+		return false;
+
+	if (!compareIndices)
+		return true;
+
+	for (unsigned int f = 0; f < first.numFaces(); f++) {
+		if (first.faceCount(f) != second.faceCount(f))
+			return false;
+		if (!std::equal(first.faceVertices(f), first.faceVertices(f) + first.faceCount(f), second.faceVertices(f)))
+			return false;
+	}
+
+	return true;
+}
+
+unsigned long long SMesh::topologyHash(MStatus *ref) {
+	return topology(ref).hash();
+}
+
+MStatus SMesh::getTopologyHash(const MObject& mesh, unsigned long long &hash) {
+	MStatus status;
+
+	MFnMesh fnMesh(mesh, &status);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+
+	MIntArray
+		polyCounts,
+		polyIndices;
+	status = fnMesh.getVertices(polyCounts, polyIndices);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+
+	std::vector <int>
+		counts(polyCounts.length()),
+		indices(polyIndices.length());
+	polyCounts.get(counts.data());
+	polyIndices.get(indices.data());
+
+	hash = SMeshTopology::hash(fnMesh.numVertices(), fnMesh.numEdges(), counts.data(), (unsigned int)counts.size(), indices.data(), (unsigned int)indices.size());
+
+	return MS::kSuccess;
+}
+
 MStatus SMesh::smoothMesh(MMeshSmoothOptions &smoothOptions) {
 	MStatus status;
 	
+	if (m_isEditing)
+		return MS::kFailure;
+
 	unsigned int multiplier = (unsigned int)pow(2, smoothOptions.divisions());
 	if (multiplier < 2)
 		return MS::kSuccess;
@@ -102,218 +294,381 @@ MStatus SMesh::smoothMesh(MMeshSmoothOptions &smoothOptions) {
 	CHECK_MSTATUS_AND_RETURN_IT(status);
 
 	m_mesh = smoothMesh;
+	invalidateTopology();
 
-	for (auto &loop : m_activeLoops){
-		SEdgeLoop smoothLoop(&m_mesh);
-		for (unsigned int e = 0; e < loop.numEdges(); e++)
-			for (unsigned int m = 0; m < multiplier; m++) {
-				int newM = (loop.isFlipped(e)) ? (multiplier - 1 - m) : m;
-				smoothLoop.pushBack(loop[e] * multiplier + newM, loop.isFlipped(e));
-			}
-		loop = smoothLoop;
+	for (auto &loop : m_activeLoops) {
+		loop.scale(multiplier);
+		loop.setMeshPtr(&m_mesh);
 	}
 
 	return MS::kSuccess;
 }
 
-MStatus SMesh::combine(const MObjectArray& meshes, MObject& combinedMesh) {
+MStatus SMesh::combine(const MObjectArray& meshes, MObject& combinedMesh, bool transferAttributes, double weldTolerance) {
 	MStatus status;
 
 	if (0 == meshes.length() || combinedMesh.apiType()!=MFn::kMeshData)
 		return MS::kInvalidParameter;
 
-	MPointArray
-		combinedVertices;
-	MIntArray
-		combinedCounts,
-		combinedIndices;
-
-	for (unsigned int m = 0; m < meshes.length(); m++) {
+	// Mesh data is read into plain arrays on this thread, workers never touch Maya
+	struct MeshBlock {
+		std::vector <float>
+			points,
+			U,
+			V;
+		std::vector <int>
+			counts,
+			indices,
+			uvCounts,
+			uvIndices,
+			lockedFaceVertices;
+		std::vector <SVec3>
+			lockedNormals;
+		unsigned int
+			pointOffset,
+			faceOffset,
+			indexOffset,
+			uvOffset,
+			uvIndexOffset,
+			lockedOffset;
+	};
+
+	unsigned int numMeshes = meshes.length();
+	std::vector <MeshBlock> blocks(numMeshes);
+
+	// First pass reads every mesh and sizes the output
+	unsigned int
+		numPoints = 0,
+		numFaces = 0,
+		numIndices = 0,
+		numUVs = 0,
+		numUVIndices = 0,
+		numLocked = 0;
+
+	for (unsigned int m = 0; m < numMeshes; m++) {
 		if (meshes[m].apiType() != MFn::kMeshData)
 			return MS::kInvalidParameter;
 
-		unsigned int vtxCount = combinedVertices.length();
+		MeshBlock &block = blocks[m];
+		MFnMesh fnMesh(meshes[m], &status);
+		CHECK_MSTATUS_AND_RETURN_IT(status);
 
-		MPointArray
-			meshPoints;
-		MIntArray
-			polyCounts,
-			polyIndices;
+		MFloatPointArray meshPoints;
+		status = fnMesh.getPoints(meshPoints);
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+		block.points.resize(4 * meshPoints.length());
+		meshPoints.get(reinterpret_cast<float(*)[4]>(block.points.data()));
 
-		MFnMesh fnMesh(meshes[m], &status);
-		fnMesh.getPoints(meshPoints);
-		fnMesh.getVertices(polyCounts, polyIndices);
+		MIntArray meshCounts, meshIndices;
+		status = fnMesh.getVertices(meshCounts, meshIndices);
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+		SMeshAdapter::toIntVector(meshCounts, block.counts);
+		SMeshAdapter::toIntVector(meshIndices, block.indices);
 
-		for (unsigned int p = 0; p < meshPoints.length(); p++)
-			combinedVertices.append(meshPoints[p]);
+		if (transferAttributes) {
+			MString uvSetName = fnMesh.currentUVSetName();
+			MFloatArray U, V;
+			status = fnMesh.getUVs(U, V, &uvSetName);
+			CHECK_MSTATUS_AND_RETURN_IT(status);
+			block.U.resize(U.length());
+			block.V.resize(V.length());
+			U.get(block.U.data());
+			V.get(block.V.data());
 
-		for (unsigned int c = 0; c < polyCounts.length(); c++)
-			combinedCounts.append(polyCounts[c]);
+			MIntArray uvCounts, uvIndices;
+			status = fnMesh.getAssignedUVs(uvCounts, uvIndices, &uvSetName);
+			CHECK_MSTATUS_AND_RETURN_IT(status);
+			SMeshAdapter::toIntVector(uvCounts, block.uvCounts);
+			SMeshAdapter::toIntVector(uvIndices, block.uvIndices);
+
+			// Only locked normals are carried, Maya recomputes the rest
+			MFloatVectorArray normals;
+			MIntArray
+				normalCounts,
+				normalIds;
+			status = fnMesh.getNormals(normals);
+			CHECK_MSTATUS_AND_RETURN_IT(status);
+			status = fnMesh.getNormalIds(normalCounts, normalIds);
+			CHECK_MSTATUS_AND_RETURN_IT(status);
+			for (unsigned int i = 0; i < normalIds.length(); i++)
+				if (fnMesh.isNormalLocked(normalIds[i])) {
+					const MFloatVector &normal = normals[normalIds[i]];
+					block.lockedFaceVertices.push_back(i);
+					block.lockedNormals.push_back(SVec3(normal.x, normal.y, normal.z));
+				}
+		}
 
-		for (unsigned int i = 0; i < polyIndices.length(); i++)
-			combinedIndices.append(polyIndices[i] + vtxCount);
+		block.pointOffset = numPoints;
+		block.faceOffset = numFaces;
+		block.indexOffset = numIndices;
+		block.uvOffset = numUVs;
+		block.uvIndexOffset = numUVIndices;
+		block.lockedOffset = numLocked;
+
+		numPoints += (unsigned int)block.points.size() / 4;
+		numFaces += (unsigned int)block.counts.size();
+		numIndices += (unsigned int)block.indices.size();
+		numUVs += (unsigned int)block.U.size();
+		numUVIndices += (unsigned int)block.uvIndices.size();
+		numLocked += (unsigned int)block.lockedFaceVertices.size();
 	}
 
+	std::vector <float>
+		points(4 * numPoints),
+		U(numUVs),
+		V(numUVs);
+	std::vector <int>
+		counts(numFaces),
+		indices(numIndices),
+		uvCounts(transferAttributes ? numFaces : 0),
+		uvIndices(numUVIndices),
+		lockedFaces(numLocked),
+		lockedVertices(numLocked);
+	std::vector <double>
+		lockedNormals(3 * numLocked);
+
+	// Every mesh copies its own block of the presized output
+	SParallel::forChunks(numMeshes, SParallel::numChunks(numMeshes, 1), [&](unsigned int, unsigned int begin, unsigned int end) {
+		for (unsigned int m = begin; m < end; m++) {
+			const MeshBlock &block = blocks[m];
+
+			std::copy(block.points.begin(), block.points.end(), points.begin() + 4 * block.pointOffset);
+			std::copy(block.counts.begin(), block.counts.end(), counts.begin() + block.faceOffset);
+			for (unsigned int i = 0; i < block.indices.size(); i++)
+				indices[block.indexOffset + i] = block.indices[i] + block.pointOffset;
+
+			if (!transferAttributes)
+				continue;
+
+			std::copy(block.U.begin(), block.U.end(), U.begin() + block.uvOffset);
+			std::copy(block.V.begin(), block.V.end(), V.begin() + block.uvOffset);
+			std::copy(block.uvCounts.begin(), block.uvCounts.end(), uvCounts.begin() + block.faceOffset);
+			for (unsigned int i = 0; i < block.uvIndices.size(); i++)
+				uvIndices[block.uvIndexOffset + i] = block.uvIndices[i] + block.uvOffset;
+
+			unsigned int face = 0, faceEnd = 0, locked = 0;
+			for (unsigned int i = 0; i < block.indices.size() && locked < block.lockedFaceVertices.size(); i++) {
+				while (faceEnd <= i)
+					faceEnd += block.counts[face++];
+				if ((int)i != block.lockedFaceVertices[locked])
+					continue;
+
+				unsigned int l = block.lockedOffset + locked;
+				lockedFaces[l] = block.faceOffset + face - 1;
+				lockedVertices[l] = indices[block.indexOffset + i];
+				lockedNormals[3 * l] = block.lockedNormals[locked].x;
+				lockedNormals[3 * l + 1] = block.lockedNormals[locked].y;
+				lockedNormals[3 * l + 2] = block.lockedNormals[locked].z;
+				locked++;
+			}
+		}
+	});
+
+	// Weld coincident border vertices of different meshes
+	if (0 < weldTolerance) {
+		std::vector <std::vector <unsigned int>> meshBorders(numMeshes);
+		std::vector <char> isBuilt(numMeshes, 0);
+		SParallel::forChunks(numMeshes, SParallel::numChunks(numMeshes, 1), [&](unsigned int, unsigned int begin, unsigned int end) {
+			for (unsigned int m = begin; m < end; m++) {
+				const MeshBlock &block = blocks[m];
+
+				SMeshTopology meshTopology;
+				if (!meshTopology.build((unsigned int)block.points.size() / 4, block.counts, block.indices))
+					continue;
+				isBuilt[m] = 1;
+
+				for (unsigned int v = 0; v < meshTopology.numVertices(); v++)
+					if (meshTopology.onBoundary(v))
+						meshBorders[m].push_back(block.pointOffset + v);
+			}
+		});
+
+		for (unsigned int m = 0; m < numMeshes; m++)
+			if (!isBuilt[m])
+				return MS::kFailure;
+
+		std::vector <unsigned int>
+			border,
+			borderMesh;
+		std::vector <double> borderPoints;
+		for (unsigned int m = 0; m < numMeshes; m++)
+			for (auto &vertex : meshBorders[m]) {
+				border.push_back(vertex);
+				borderMesh.push_back(m);
+				for (unsigned int i = 0; i < 3; i++)
+					borderPoints.push_back(points[4 * vertex + i]);
+			}
+
+		SSpatialGrid grid;
+		grid.build(borderPoints, weldTolerance);
+
+		// Every set remembers its source meshes in ascending order, two sets holding vertices of the
+		// same mesh are never united so a mesh can't weld to itself through a third one
+		SUnionFind sets((unsigned int)border.size());
+		std::vector <std::vector <unsigned int>> setMeshes(border.size());
+		for (unsigned int i = 0; i < border.size(); i++)
+			setMeshes[i].push_back(borderMesh[i]);
+
+		for (unsigned int i = 0; i < border.size(); i++)
+			grid.query(grid.point(i), weldTolerance, [&](unsigned int j, double) {
+				unsigned int
+					first = sets.find(i),
+					second = sets.find(j);
+				if (first == second)
+					return;
+
+				std::vector <unsigned int> merged;
+				std::merge(setMeshes[first].begin(), setMeshes[first].end(), setMeshes[second].begin(), setMeshes[second].end(), std::back_inserter(merged));
+				if (std::adjacent_find(merged.begin(), merged.end()) != merged.end())
+					return;
+
+				sets.unite(first, second);
+				setMeshes[std::min(first, second)].swap(merged);
+				setMeshes[std::max(first, second)].clear();
+			});
+
+		// Border is in ascending vertex order, so the root of a set is also its lowest vertex
+		std::vector <unsigned int> roots(numPoints);
+		for (unsigned int v = 0; v < numPoints; v++)
+			roots[v] = v;
+		for (unsigned int i = 0; i < border.size(); i++)
+			roots[border[i]] = border[sets.find(i)];
+
+		// Welded vertices keep the position of the lowest vertex they merged with
+		std::vector <int> newIds(numPoints);
+		unsigned int numWelded = 0;
+		for (unsigned int v = 0; v < numPoints; v++) {
+			unsigned int root = roots[v];
+			if (root != v) {
+				newIds[v] = newIds[root];
+				continue;
+			}
+			for (unsigned int i = 0; i < 4; i++)
+				points[4 * numWelded + i] = points[4 * v + i];
+			newIds[v] = numWelded++;
+		}
+
+		numPoints = numWelded;
+		points.resize(4 * numPoints);
+		for (auto &index : indices)
+			index = newIds[index];
+		for (auto &vertex : lockedVertices)
+			vertex = newIds[vertex];
+	}
+
+	MFloatPointArray combinedPoints(reinterpret_cast<const float(*)[4]>(points.data()), numPoints);
+	MIntArray
+		combinedCounts(counts.data(), numFaces),
+		combinedIndices(indices.data(), numIndices);
+
 	MFnMesh fnMesh;
+	if (!transferAttributes) {
+		fnMesh.create(
+			numPoints,
+			numFaces,
+			combinedPoints,
+			combinedCounts,
+			combinedIndices,
+			combinedMesh,
+			&status);
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+
+		return MS::kSuccess;
+	}
+
 	fnMesh.create(
-		combinedVertices.length(),
-		combinedCounts.length(),
-		combinedVertices,
+		numPoints,
+		numFaces,
+		combinedPoints,
 		combinedCounts,
 		combinedIndices,
+		MFloatArray(U.data(), numUVs),
+		MFloatArray(V.data(), numUVs),
 		combinedMesh,
 		&status);
 	CHECK_MSTATUS_AND_RETURN_IT(status);
 
+	status = fnMesh.assignUVs(MIntArray(uvCounts.data(), numFaces), MIntArray(uvIndices.data(), numUVIndices));
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+
+	if (0 < numLocked) {
+		MVectorArray normals(reinterpret_cast<const double(*)[3]>(lockedNormals.data()), numLocked);
+		MIntArray
+			faces(lockedFaces.data(), numLocked),
+			vertices(lockedVertices.data(), numLocked);
+		status = fnMesh.setFaceVertexNormals(normals, faces, vertices);
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+	}
+
 	return MS::kSuccess;
 }
 
 MStatus SMesh::detachEdges(const MIntArray &edges) {
 	MStatus status;
 
-	MFnMesh fnMesh(m_mesh);
-
-	MPointArray
-		meshPoints;
-	MFloatVectorArray
-		meshNormals;
-	MIntArray
-		polyCounts,
-		polyIndices;
-
-	fnMesh.getPoints(meshPoints);
-	fnMesh.getVertexNormals(true, meshNormals);
-	fnMesh.getVertices(polyCounts, polyIndices);
-
-	// Feed polygon info in more convenient form
-	std::vector <SMeshPolygon> meshPolygons;
-	unsigned int currentId = 0;
-	for (unsigned int f = 0; f < polyCounts.length(); f++) {
-		unsigned int currentMax = currentId + polyCounts[f];
-		SMeshPolygon polygon;
-		for (currentId; currentId < currentMax; currentId++)
-			polygon.append(polyIndices[currentId]);
-		meshPolygons.push_back(polygon);
+	bool isImplicit = !m_isEditing;
+	if (isImplicit) {
+		status = beginEdit();
+		CHECK_MSTATUS_AND_RETURN_IT(status);
 	}
 
-	// Put edges in set for faster search
-	std::set <unsigned int> detachedEdges;
-	for (unsigned int e = 0; e < edges.length(); e++)
-		detachedEdges.insert(edges[e]);
-
-	// Now we're going to generate new ids for vertices on detached edges
-	MItMeshVertex itVertex(m_mesh);
-	for (itVertex.reset(); !itVertex.isDone(); itVertex.next()) {
-		MIntArray
-			conEdges,
-			conFaces,
-			tmpFaces;
-		int
-			numEdges,
-			numFaces;
-
-		itVertex.getConnectedEdges(conEdges);
-		itVertex.getConnectedFaces(tmpFaces);
-		itVertex.numConnectedEdges(numEdges);
-		itVertex.numConnectedFaces(numFaces);
-
-		// Since faces are ordered CW and edge CCW we reverse the faces
-		for (int i = numFaces - 1; i >= 0; i--)
-			conFaces.append(tmpFaces[i]);
-		
-		// Find the first split edge connected to current vertex. And total splits
-		int
-			startEdge = -1,
-			numSplits = 0;
-
-		for (int e = 0; e < numEdges; e++) {
-			if (detachedEdges.find(conEdges[e]) != detachedEdges.end()) {
-				if (startEdge < 0)
-					startEdge = e;
-				numSplits++;
-			}
-		}
-		if (itVertex.onBoundary())
-			startEdge = 0;
-		
-		// Skip interior vertices with only one split and vertices without split
-		if ((numSplits==1 && !itVertex.onBoundary()) || numSplits == 0)
-			continue;
-
-		// Iterating over faces, replacing old vertices with new. Every time we cross a split edge we create new vertex
-		unsigned int newVtxId = itVertex.index();
-		for (int f = 0; f < numFaces; f++) {
-			int relativeIdx = (startEdge + f) % numFaces;
-			if (f != 0 && detachedEdges.find(conEdges[relativeIdx]) != detachedEdges.end()) {
-				newVtxId = meshPoints.length();
-				meshPoints.append(meshPoints[itVertex.index()]);
-				meshNormals.append(meshNormals[itVertex.index()]);
-				m_vtxMap[newVtxId] = itVertex.index();
-				m_vtxSplitValence[newVtxId] = numSplits;
-			}
-			if (newVtxId != itVertex.index())
-				meshPolygons[conFaces[relativeIdx]].replace(itVertex.index(), newVtxId);
-			m_vtxSplitValence[newVtxId] = numSplits;
-		}
-	}
+	status = loadVertexNormals();
+	if (status != MS::kSuccess)
+		return endEdit(isImplicit, status);
 
-	// Update polyindices
-	polyIndices.clear();
-	for (auto &polygon : meshPolygons)
-		for (unsigned int p = 0; p < polygon.length(); p++)
-			polyIndices.append(polygon[p]);
-	
-	// Load UV sets
-	SUVSet
-		currentSet(fnMesh.currentUVSetName());
+	std::vector <int> edgeIds;
+	SMeshAdapter::toIntVector(edges, edgeIds);
+	status = m_buffer.detachEdges(edgeIds, m_vtxMap, m_vtxSplitValence) ? MS::kSuccess : MS::kInvalidParameter;
 
-	status = fnMesh.getUVs(currentSet.U, currentSet.V);
-	CHECK_MSTATUS_AND_RETURN_IT(status);
-	status = fnMesh.getAssignedUVs(currentSet.uvCounts, currentSet.uvIndices);
-	CHECK_MSTATUS_AND_RETURN_IT(status);
+	return endEdit(isImplicit, status);
+}
 
-	// Update mesh
-	fnMesh.create(
-		meshPoints.length(),
-		polyCounts.length(),
-		meshPoints,
-		polyCounts,
-		polyIndices,
-		currentSet.U,
-		currentSet.V,
-		m_mesh,
-		&status
-	);
-	CHECK_MSTATUS_AND_RETURN_IT(status);
 
-	status = fnMesh.assignUVs(currentSet.uvCounts, currentSet.uvIndices);
-	CHECK_MSTATUS_AND_RETURN_IT(status);
+// Shared normals come from Maya while the buffer still matches the mesh
+MStatus SMesh::loadVertexNormals() {
+	MStatus status;
 
-	// Get shared normals used by this class for parallel flanges etc.
-	MVectorArray newNormals;
-	for (unsigned int i = 0; i<meshNormals.length(); i++)
-		newNormals.append(meshNormals[i]);
+	if (!m_isEditing)
+		return MS::kFailure;
 
-	setNormals(newNormals);
+	if (!m_buffer.isModified() && !m_buffer.hasVertexNormals) {
+		status = SMeshAdapter::getVertexNormals(m_mesh, m_buffer.vertexNormals);
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+		m_buffer.hasVertexNormals = true;
+	}
 
 	return MS::kSuccess;
 }
 
-
 MVector SMesh::getEdgeVector(int edge, int fromVertex) {
 	
-	MFnMesh fnMesh(m_mesh);
 	int vertices[2];
-	fnMesh.getEdgeVertices(edge, vertices);
+	topology().getEdgeVertices(edge, vertices);
 
 	MPoint A, B;
-	fnMesh.getPoint(vertices[0], A);
-	fnMesh.getPoint(vertices[1], B);
+	if (m_isEditing) {
+		A = SMeshAdapter::toPoint(m_buffer.points[vertices[0]]);
+		B = SMeshAdapter::toPoint(m_buffer.points[vertices[1]]);
+	}
+	else {
+		MFnMesh fnMesh(m_mesh);
+		fnMesh.getPoint(vertices[0], A);
+		fnMesh.getPoint(vertices[1], B);
+	}
 	
 	return (fromVertex == vertices[0]) ? B - A : A - B;
 }
 
 MStatus SMesh::setNormals(const MVectorArray& normals) {
+	if (m_isEditing) {
+		if (normals.length() != m_buffer.numVertices())
+			return MS::kInvalidParameter;
+
+		SMeshAdapter::toVec3Array(normals, m_buffer.normals);
+		m_buffer.areNormalsModified = true;
+		return MS::kSuccess;
+	}
+
 	MFnMesh fnMesh(m_mesh);
 	
 	if (normals.length() != fnMesh.numVertices())
@@ -324,39 +679,55 @@ MStatus SMesh::setNormals(const MVectorArray& normals) {
 }
 
 void SMesh::getNormals(MVectorArray& normals) {
-	normals = m_normals;
+	if (m_isEditing)
+		SMeshAdapter::toVectorArray(m_buffer.normals, normals);
+	else
+		normals = m_normals;
 }
 
 MStatus SMesh::updateMesh(const MObject& sourceMesh) {
 	MStatus status;
 
+	if (m_isEditing)
+		return MS::kFailure;
+
 	if (sourceMesh.apiType() != MFn::kMeshData)
 		return MS::kInvalidParameter;
 
 	MFnMesh fnSrcMesh(sourceMesh);
 	MFnMesh fnTrgMesh(m_mesh);
 
-	MPointArray
-		srcPoints,
-		trgPoints;
-	MFloatVectorArray
-		srcNormals;
-	MVectorArray
-		trgNormals;
+	unsigned int
+		numSrcVertices = fnSrcMesh.numVertices(),
+		numTrgVertices = fnTrgMesh.numVertices();
+	if (m_vtxMap.size() < numTrgVertices)
+		resizeVertexMaps(numTrgVertices);
 
-	fnSrcMesh.getPoints(srcPoints);
-	fnSrcMesh.getVertexNormals(true, srcNormals);
+	const float *srcPoints = fnSrcMesh.getRawPoints(&status);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+	MFloatVectorArray srcNormals;
+	status = fnSrcMesh.getVertexNormals(true, srcNormals);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
 
-	for (int v = 0; v < fnTrgMesh.numVertices(); v++) {
-		if (srcPoints.length() <= m_vtxMap[v])
+	// Gather straight into presized arrays, the mesh is only touched once the whole map is valid
+	MFloatPointArray trgPoints(numTrgVertices);
+	MVectorArray trgNormals(numTrgVertices);
+	for (unsigned int v = 0; v < numTrgVertices; v++) {
+		unsigned int srcVtxId = m_vtxMap[v];
+		if (numSrcVertices <= srcVtxId)
 			return MS::kFailure;
-		int srcVtxId = m_vtxMap[v];
-		trgPoints.append(srcPoints[srcVtxId]);
-		trgNormals.append(srcNormals[srcVtxId]);
+		const float *point = srcPoints + 3 * srcVtxId;
+		trgPoints[v] = MFloatPoint(point[0], point[1], point[2]);
+		trgNormals[v] = srcNormals[srcVtxId];
 	}
 
-	fnTrgMesh.setPoints(trgPoints);
-	setNormals(trgNormals);
+	status = fnTrgMesh.setPoints(trgPoints);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+	m_normals = trgNormals;
+
+	// Every vertex may have moved, cached loop geometry is stale
+	for (auto &loop : m_activeLoops)
+		loop.invalidate();
 
 	return MS::kSuccess;
 }
@@ -368,12 +739,13 @@ MStatus SMesh::getEdgeVertices(const MIntArray& edges, MIntArray& vertices) {
 
 	std::set <unsigned int> vtxId;
 	
-	MFnMesh fnMesh(m_mesh, &status);
+	const SMeshTopology &meshTopology = topology(&status);
 	CHECK_MSTATUS_AND_RETURN_IT(status);
 	for (unsigned int i = 0; i < edges.length(); i++){
+		if (edges[i] < 0 || meshTopology.numEdges() <= (unsigned int)edges[i])
+			return MS::kInvalidParameter;
 		int vertices[2];
-		status = fnMesh.getEdgeVertices(edges[i], vertices);
-		CHECK_MSTATUS_AND_RETURN_IT(status);
+		meshTopology.getEdgeVertices(edges[i], vertices);
 		vtxId.insert(std::begin(vertices), std::end(vertices));
 	}
 
@@ -386,31 +758,17 @@ MStatus SMesh::getEdgeVertices(const MIntArray& edges, MIntArray& vertices) {
 MStatus SMesh::pullVertices(const MIntArray& vertices, const float distance) {
 	MStatus status;
 
-	MFnMesh fnMesh(m_mesh, &status);
-	CHECK_MSTATUS_AND_RETURN_IT(status);
-
-	MPointArray
-		meshPoints;
-	MVectorArray
-		meshNormals;
-
-	std::set <unsigned int> done;
-
-	fnMesh.getPoints(meshPoints);
-	getNormals(meshNormals);
-
-	for (unsigned int i = 0; i < vertices.length(); i++)
-		if ((int)meshPoints.length() <= vertices[i])
-			return MS::kInvalidParameter;
-		else
-			if (done.find(vertices[i]) == done.end()) {
-				meshPoints[vertices[i]] += meshNormals[vertices[i]] * distance;
-				done.insert(vertices[i]);
-			}
+	bool isImplicit = !m_isEditing;
+	if (isImplicit) {
+		status = beginEdit();
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+	}
 
-	fnMesh.setPoints(meshPoints);
+	std::vector <int> vertexIds;
+	SMeshAdapter::toIntVector(vertices, vertexIds);
+	status = m_buffer.pullVertices(vertexIds, distance) ? MS::kSuccess : MS::kInvalidParameter;
 
-	return MS::kSuccess;
+	return endEdit(isImplicit, status);
 }
 
 MStatus SMesh::getBoundaryEdges(MIntArray &edges) {
@@ -418,12 +776,12 @@ MStatus SMesh::getBoundaryEdges(MIntArray &edges) {
 
 	edges.clear();
 
-	MItMeshEdge itEdge(m_mesh, &status);
+	const SMeshTopology &meshTopology = topology(&status);
 	CHECK_MSTATUS_AND_RETURN_IT(status);
 
-	for (itEdge.reset(); !itEdge.isDone(); itEdge.next())
-		if (itEdge.onBoundary())
-			edges.append(itEdge.index());
+	for (unsigned int e = 0; e < meshTopology.numEdges(); e++)
+		if (meshTopology.edgeOnBoundary(e))
+			edges.append(e);
 
 	return MS::kSuccess;
 }
@@ -432,141 +790,54 @@ MStatus SMesh::getBoundaryEdges(MIntArray &edges) {
 MStatus SMesh::extrudeEdges(const MIntArray& edges, const float thickness, const unsigned int divisions) {
 	MStatus status;
 
-	unsigned int numSegments = divisions + 1;
-	float divisionThickness = thickness / numSegments;
-
-	MPointArray
-		meshPoints;
-	MIntArray
-		polyCounts,
-		polyIndices;
-	MVectorArray
-		meshNormals;
-
-	MFnMesh fnMesh(m_mesh);
-	fnMesh.getPoints(meshPoints);
-	fnMesh.getVertices(polyCounts, polyIndices);
-	getNormals(meshNormals);
-
-	// Load UV sets
-	SUVSet currentSet(fnMesh.currentUVSetName());
-	status = fnMesh.getUVs(currentSet.U, currentSet.V);
-	CHECK_MSTATUS_AND_RETURN_IT(status);
-	status = fnMesh.getAssignedUVs(currentSet.uvCounts, currentSet.uvIndices);
-	CHECK_MSTATUS_AND_RETURN_IT(status);
-
-	// <division level <original id, extruded id>
-	std::map <unsigned int, std::map <unsigned int, unsigned int>> mapIds;
-
-	for (unsigned int e = 0; e < edges.length(); e++) {
-		int vertices[2];
-		fnMesh.getEdgeVertices(edges[e], vertices);
-
-		for (unsigned int d = 0; d < numSegments; d++) {
-			// Start polygon with original vertices
-			for (unsigned int i = 0; i < 2; i++) {
-				int vtxId = vertices[(i == 0) ? 1 : 0];
-				int divVtxId = (d == 0) ? vtxId : mapIds[d - 1][vtxId];
-				polyIndices.append(divVtxId);
-			}
-
-			// Complete polygon with extruded vertices
-			for (unsigned int i = 0; i < 2; i++) {
-				int vtxId = vertices[i];
-
-				// Define new vertex if necessary
-				if (mapIds[d].find(vtxId) == mapIds[d].end()) {
-					float extDistance = (d + 1)*divisionThickness*(-1);
-					MPoint extrudedPoint = meshPoints[vtxId] + extDistance*meshNormals[vtxId];
-					mapIds[d][vtxId] = meshPoints.length();
-					meshPoints.append(extrudedPoint);
-				}
-				polyIndices.append(mapIds[d][vtxId]);
-			}
-			polyCounts.append(4);
-			currentSet.addPolygon();
-		}
+	bool isImplicit = !m_isEditing;
+	if (isImplicit) {
+		status = beginEdit();
+		CHECK_MSTATUS_AND_RETURN_IT(status);
 	}
 
-	// Update mesh
-	fnMesh.create(
-		meshPoints.length(),
-		polyCounts.length(),
-		meshPoints,
-		polyCounts,
-		polyIndices,
-		currentSet.U,
-		currentSet.V,
-		m_mesh,
-		&status
-	);
-	CHECK_MSTATUS_AND_RETURN_IT(status);
-
-	status = fnMesh.assignUVs(currentSet.uvCounts, currentSet.uvIndices);
-	CHECK_MSTATUS_AND_RETURN_IT(status);
+	std::vector <int> edgeIds;
+	SMeshAdapter::toIntVector(edges, edgeIds);
+	status = m_buffer.extrudeEdges(edgeIds, thickness, divisions) ? MS::kSuccess : MS::kInvalidParameter;
 
-	return MS::kSuccess;
+	return endEdit(isImplicit, status);
 }
 
 MStatus SMesh::setActiveEdges(const MIntArray& edges) {
 	MStatus status;
 
 	m_activeLoops.clear();
-	
-	std::set <unsigned int> remainingEdges;
-	for (unsigned int e = 0; e < edges.length(); e++)
-		remainingEdges.insert(edges[e]);
-
-	// Check if mesh contains listed edges
-	MFnMesh fnMesh(m_mesh, &status);
-	CHECK_MSTATUS_AND_RETURN_IT(status);
-	unsigned int numEdges = fnMesh.numEdges();
-	if(*remainingEdges.rbegin() >= numEdges)
-		return MS::kInvalidParameter;
 
-	MItMeshVertex itVertex(m_mesh, &status);
+	const SMeshTopology &meshTopology = topology(&status);
 	CHECK_MSTATUS_AND_RETURN_IT(status);
-	for (itVertex.reset(); !itVertex.isDone(); itVertex.next()) {
-		int
-			prevId,
-			vertId = itVertex.index();
-
-		MIntArray conEdges;
-		itVertex.getConnectedEdges(conEdges);
-		unsigned int numEdges = conEdges.length();
-		
-		for (unsigned int e = 0; e < numEdges; e++) {
-			int edgeId = conEdges[e];
-			if (remainingEdges.find(edgeId) == remainingEdges.end())
-				continue;
 
-			SEdgeLoop edgeLoop(&m_mesh);
-			itVertex.setIndex(vertId, prevId);
-			status = contiguousEdges(itVertex, remainingEdges, edgeLoop, edgeId);
-			CHECK_MSTATUS_AND_RETURN_IT(status);
+	std::vector <int> edgeIds;
+	SMeshAdapter::toIntVector(edges, edgeIds);
 
-			// Explore edge in opposite direction
-			if ((!itVertex.onBoundary() && numEdges == 4 && e<2) || (itVertex.onBoundary() && 2<numEdges && e == 0)) {
-				int relOutIdx = (itVertex.onBoundary()) ? numEdges - 1 : e + 2;
-				int outIdx = conEdges[relOutIdx];
-				if (remainingEdges.find(outIdx) != remainingEdges.end()) {	
-					itVertex.setIndex(vertId, prevId);
-					status = contiguousEdges(itVertex, remainingEdges, edgeLoop, outIdx);
-					CHECK_MSTATUS_AND_RETURN_IT(status);
-				}
-			}
+	return buildActiveLoops(meshTopology, edgeIds);
+}
 
-			if (0 < edgeLoop.numEdges())
-				m_activeLoops.push_back(edgeLoop);
+MStatus SMesh::buildActiveLoops(const SMeshTopology &meshTopology, const std::vector <int> &edges) {
+	m_activeLoops.clear();
 
-			if (remainingEdges.size() == 0)
-				break;
-		}
+	// Check if mesh contains listed edges
+	for (auto &edge : edges)
+		if (edge < 0 || meshTopology.numEdges() <= (unsigned int)edge)
+			return MS::kInvalidParameter;
 
-		if (remainingEdges.size() == 0)
-			break;
+	std::vector <int>
+		loopOffsets,
+		loopEdges;
+	std::vector <bool> loopFlipped;
+	if (!meshTopology.findEdgeLoops(edges, loopOffsets, loopEdges, loopFlipped))
+		return MS::kFailure;
 
-		itVertex.setIndex(vertId, prevId);
+	m_activeLoops.reserve(loopOffsets.size() - 1);
+	for (unsigned int l = 0; l + 1 < loopOffsets.size(); l++) {
+		SEdgeLoop edgeLoop(&m_mesh);
+		for (int i = loopOffsets[l]; i < loopOffsets[l + 1]; i++)
+			edgeLoop.pushBack(loopEdges[i], loopFlipped[i]);
+		m_activeLoops.push_back(edgeLoop);
 	}
 
 	return MS::kSuccess;
@@ -621,74 +892,48 @@ MStatus	SMesh::groupConnectedComponents(const MObject &component, MObjectArray&
 	MIntArray compIndices;
 	fnComponent.getElements(compIndices);
 
-	std::set <unsigned int> compSet;
-	for (unsigned int i = 0; i < compIndices.length(); i++)
-		compSet.insert(compIndices[i]);
-
-	// Group faces
-	if (component.apiType() == MFn::kMeshPolygonComponent) {
-		MItMeshPolygon itPolygon(m_mesh);
-		while (compSet.size() != 0) {
-			int currentId = *compSet.begin(), previousId;
-			compSet.erase(currentId);
-			MIntArray groupIndices;
-			groupIndices.append(currentId);
-
-			status = itPolygon.setIndex(currentId, previousId);
-			CHECK_MSTATUS_AND_RETURN_IT(status);
-	
-			status = groupConnectedFaces(itPolygon, compSet, groupIndices);
-			CHECK_MSTATUS_AND_RETURN_IT(status);
+	const SMeshTopology &meshTopology = topology(&status);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
 
-			MFnSingleIndexedComponent fnGroupComponent;
-			MObject groupComponent = fnGroupComponent.create(MFn::kMeshPolygonComponent, &status);
-			CHECK_MSTATUS_AND_RETURN_IT(status);
+	std::vector <int>
+		elements,
+		groupOffsets,
+		groupedElements;
+	SMeshAdapter::toIntVector(compIndices, elements);
+	status = groupElements(meshTopology, component.apiType(), elements, groupOffsets, groupedElements);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
 
-			fnGroupComponent.addElements(groupIndices);
-			componentGroups.append(groupComponent);
-		}
-	}
-	// Group vertices
-	else if (component.apiType() == MFn::kMeshVertComponent) {
-		MItMeshVertex itVertex(m_mesh);
-		while (compSet.size() != 0) {
-			int currentId = *compSet.begin(), previousId;
-			compSet.erase(currentId);
-			MIntArray groupIndices;
-			groupIndices.append(currentId);
-
-			status = itVertex.setIndex(currentId, previousId);
-			CHECK_MSTATUS_AND_RETURN_IT(status);
+	return createComponentGroups(component.apiType(), groupOffsets, groupedElements, componentGroups);
+}
 
-			status = groupConnectedVertices(itVertex, compSet, groupIndices);
-			CHECK_MSTATUS_AND_RETURN_IT(status);
+// Faces and vertices are grouped by connectivity, edges by the loops they form. Edge loops
+// become the active loops of the mesh.
+MStatus SMesh::groupElements(const SMeshTopology &meshTopology, MFn::Type type, const std::vector <int> &elements, std::vector <int> &groupOffsets, std::vector <int> &groupedElements) {
+	MStatus status;
 
-			MFnSingleIndexedComponent fnGroupComponent;
-			MObject groupComponent = fnGroupComponent.create(MFn::kMeshVertComponent, &status);
-			CHECK_MSTATUS_AND_RETURN_IT(status);
+	groupOffsets.clear();
+	groupedElements.clear();
 
-			fnGroupComponent.addElements(groupIndices);
-			componentGroups.append(groupComponent);
-		}
+	// Group faces and vertices
+	if (type == MFn::kMeshPolygonComponent || type == MFn::kMeshVertComponent) {
+		bool result = (type == MFn::kMeshPolygonComponent) ?
+			meshTopology.groupConnectedFaces(elements, groupOffsets, groupedElements) :
+			meshTopology.groupConnectedVertices(elements, groupOffsets, groupedElements);
+		if (!result)
+			return MS::kInvalidParameter;
 	}
 	// Group edges
-	else if (component.apiType() == MFn::kMeshEdgeComponent)
+	else if (type == MFn::kMeshEdgeComponent)
 	{
-		status = setActiveEdges(compIndices);
+		status = buildActiveLoops(meshTopology, elements);
 		CHECK_MSTATUS_AND_RETURN_IT(status);
-		std::vector<SEdgeLoop> loops;
-		getActiveLoops(loops);
-
-		for (auto &loop : loops) {
-			MIntArray groupIndices;
-			loop.get(groupIndices);
 
-			MFnSingleIndexedComponent fnGroupComponent;
-			MObject groupComponent = fnGroupComponent.create(MFn::kMeshEdgeComponent, &status);
-			CHECK_MSTATUS_AND_RETURN_IT(status);
-
-			fnGroupComponent.addElements(groupIndices);
-			componentGroups.append(groupComponent);
+		groupOffsets.push_back(0);
+		std::vector <unsigned int> loopEdges;
+		for (auto &loop : m_activeLoops) {
+			loop.get(loopEdges);
+			groupedElements.insert(groupedElements.end(), loopEdges.begin(), loopEdges.end());
+			groupOffsets.push_back((int)groupedElements.size());
 		}
 	}
 	else
@@ -697,116 +942,21 @@ MStatus	SMesh::groupConnectedComponents(const MObject &component, MObjectArray&
 	return MS::kSuccess;
 }
 
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// Protected methods //////////////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////////////
-
-MStatus SMesh::groupConnectedFaces(MItMeshPolygon &itPolygon, std::set <unsigned int> &compSet, MIntArray &indices) {
+MStatus SMesh::createComponentGroups(MFn::Type type, const std::vector <int> &groupOffsets, const std::vector <int> &groupedElements, MObjectArray &componentGroups) {
 	MStatus status;
 
-	MIntArray connectedFaces;
-	itPolygon.getConnectedFaces(connectedFaces);
-
-	for (unsigned int f = 0; f < connectedFaces.length(); f++) {
-		int currentId = connectedFaces[f], previousId;
-
-		if (compSet.find(currentId) != compSet.end()) {
-			compSet.erase(currentId);
-			indices.append(currentId);
-
-			status = itPolygon.setIndex(currentId, previousId);
-			CHECK_MSTATUS_AND_RETURN_IT(status);
-
-			status = groupConnectedFaces(itPolygon, compSet, indices);
-			CHECK_MSTATUS_AND_RETURN_IT(status);
-		}
-	}
-
-	return MS::kSuccess;
-}
-
-MStatus SMesh::groupConnectedVertices(MItMeshVertex &itVertex, std::set <unsigned int> &compSet, MIntArray &indices) {
-	MStatus status;
-
-	MIntArray connectedVertices;
-	itVertex.getConnectedVertices(connectedVertices);
-
-	for (unsigned int v = 0; v < connectedVertices.length(); v++) {
-		int currentId = connectedVertices[v], previousId;
+	componentGroups.clear();
 
-		if (compSet.find(currentId) != compSet.end()) {
-			compSet.erase(currentId);
-			indices.append(currentId);
+	for (unsigned int g = 0; g + 1 < groupOffsets.size(); g++) {
+		MIntArray groupIndices(groupedElements.data() + groupOffsets[g], groupOffsets[g + 1] - groupOffsets[g]);
 
-			status = itVertex.setIndex(currentId, previousId);
-			CHECK_MSTATUS_AND_RETURN_IT(status);
+		MFnSingleIndexedComponent fnGroupComponent;
+		MObject groupComponent = fnGroupComponent.create(type, &status);
+		CHECK_MSTATUS_AND_RETURN_IT(status);
 
-			status = groupConnectedVertices(itVertex, compSet, indices);
-			CHECK_MSTATUS_AND_RETURN_IT(status);
-		}
+		fnGroupComponent.addElements(groupIndices);
+		componentGroups.append(groupComponent);
 	}
 
-	return MS::kSuccess;
-}
-
-MStatus SMesh::contiguousEdges(MItMeshVertex &itVertex, std::set <unsigned int> &remainingEdges, SEdgeLoop &loop, const int edge) {
-	MStatus status;
-
-	status = loop.add(edge);
-	CHECK_MSTATUS_AND_RETURN_IT(status);
-	remainingEdges.erase(edge);
-
-	int nextVtx, currentIdx;
-	status = itVertex.getOppositeVertex(nextVtx, edge);
-	CHECK_MSTATUS_AND_RETURN_IT(status);
-	status = itVertex.setIndex(nextVtx, currentIdx);
-	CHECK_MSTATUS_AND_RETURN_IT(status);
-	status = extendEdgeLoop(itVertex, remainingEdges, loop);
-	CHECK_MSTATUS_AND_RETURN_IT(status);
-
-	return MS::kSuccess;
-}
-
-MStatus SMesh::extendEdgeLoop(MItMeshVertex &itVertex, std::set <unsigned int> &remainingEdges, SEdgeLoop &activeLoop) {
-	MStatus status;
-
-	if (0 == activeLoop.numEdges())
-		return MS::kInvalidParameter;
-
-	MIntArray conEdges;
-	itVertex.getConnectedEdges(conEdges);
-	unsigned int numEdges = conEdges.length();
-
-	// End loop once you hit star-shaped vertex
-	if ((itVertex.onBoundary() && numEdges == 2) ||
-		(!itVertex.onBoundary() && numEdges != 4))
-		return MS::kSuccess;
-
-	// Find vertex relative index of incoming edge
-	int relInIdx = -1;
-	for (unsigned int e=0; e < numEdges; e++)
-		if (conEdges[e] == activeLoop[0] ||
-			conEdges[e] == activeLoop[activeLoop.numEdges() - 1]) {
-			relInIdx = e;
-			break;
-		}
-	if (relInIdx < 0)
-		return MS::kFailure;
-
-	// End loop once boundary is reached
-	if (itVertex.onBoundary() && (relInIdx != 0 && relInIdx != numEdges - 1))
-		return MS::kSuccess;
-
-	// Find index of outcoming edge
-	int relOutIdx;
-	if (itVertex.onBoundary())
-		relOutIdx = (relInIdx==0) ? numEdges - 1 : 0;
-	else
-		relOutIdx = (relInIdx + 2) % numEdges;
-	int outIdx = conEdges[relOutIdx];
-
-	if (remainingEdges.find(outIdx) != remainingEdges.end())
-		contiguousEdges(itVertex, remainingEdges, activeLoop, outIdx);
-
 	return MS::kSuccess;
 }
\ No newline at end of file
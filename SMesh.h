@@ -1,6 +1,10 @@
 #pragma once
 
 #include "SEdgeLoop.h"
+#include "SMeshTopology.h"
+#include "SMeshBuffer.h"
+#include "SMeshAdapter.h"
+#include "SUVSet.h"
 
 #include <maya\MObject.h>
 #include <maya\MStatus.h>
@@ -22,6 +26,7 @@
 #include <set>
 #include <vector>
 #include <algorithm>
+#include <numeric>
 
 class SMeshArray;
 
@@ -37,11 +42,14 @@ public:
 	MObject			getObject() const;
 	bool			isNull() const;
 	static bool		isEquivalent(const MObject& firstMesh, const MObject& secondMesh, MStatus *ref = NULL);
+	bool			isEquivalent(SMesh& mesh, bool compareIndices = false, MStatus *ref = NULL);
+	unsigned long long	topologyHash(MStatus *ref = NULL);
+	static MStatus	getTopologyHash(const MObject& mesh, unsigned long long &hash);
 	MStatus			updateMesh(const MObject& sourceMesh);
 	MStatus			smoothMesh(MMeshSmoothOptions &smoothOptions);
 
 	MStatus			detachEdges(const MIntArray &edges);
-	static MStatus	combine(const MObjectArray& meshes, MObject& combinedMesh);
+	static MStatus	combine(const MObjectArray& meshes, MObject& combinedMesh, bool transferAttributes = false, double weldTolerance = 0.0);
 
 	MStatus			setNormals(const MVectorArray& normals);
 	void			getNormals(MVectorArray& normals);
@@ -63,21 +71,42 @@ public:
 
 	MStatus			groupConnectedComponents(const MObject &component, MObjectArray& componentGroups);
 
+	const SMeshTopology	&topology(MStatus *ref = NULL);
+	void			invalidateTopology();
+	static MStatus	getTopology(const MObject &mesh, SMeshTopology &topology);
+
+	// Edits between beginEdit and commitEdit are applied to an in-memory buffer and written
+	// back to the mesh with a single rebuild
+	MStatus			beginEdit();
+	MStatus			commitEdit();
+	void			cancelEdit();
+	bool			isEditing() const;
+
 protected:
 	MObject m_mesh;
 	MVectorArray m_normals;
+	SMeshTopology m_topology;
+	bool m_isTopologyDirty = true;
+	SMeshBuffer m_buffer;
+	bool m_isEditing = false;
 
-	std::map <unsigned int, unsigned int> m_vtxMap;
-	std::map <unsigned int, unsigned int> m_vtxSplitValence;
+	std::vector <unsigned int> m_vtxMap;
+	std::vector <unsigned int> m_vtxSplitValence;
 	std::vector <SEdgeLoop> m_activeLoops;
 
-	virtual MStatus extendEdgeLoop(MItMeshVertex &itVertex, std::set <unsigned int> &remainingEdges, SEdgeLoop &activeLoop);
-	virtual MStatus contiguousEdges(MItMeshVertex &itVertex, std::set <unsigned int> &remainingEdges, SEdgeLoop &loop, const int edge);
+	MStatus endEdit(bool isImplicit, MStatus status);
 
-	MStatus groupConnectedFaces(MItMeshPolygon &itPolygon, std::set <unsigned int> &compSet, MIntArray &indices);
-	MStatus groupConnectedVertices(MItMeshVertex &itVertex, std::set <unsigned int> &compSet, MIntArray &indices);
+	// Maya free parts of the edge and component operations, SMeshArray runs them on worker
+	// threads between the Maya calls it makes on the calling thread
+	MStatus loadVertexNormals();
+	MStatus buildActiveLoops(const SMeshTopology &meshTopology, const std::vector <int> &edges);
+	MStatus groupElements(const SMeshTopology &meshTopology, MFn::Type type, const std::vector <int> &elements, std::vector <int> &groupOffsets, std::vector <int> &groupedElements);
+	static MStatus createComponentGroups(MFn::Type type, const std::vector <int> &groupOffsets, const std::vector <int> &groupedElements, MObjectArray &componentGroups);
+
+	friend class SMeshArray;
 
 	virtual void copyAttributes(const SMesh& mesh);
+	void resizeVertexMaps(unsigned int numVertices);
 };
 
 class SMeshPolygon
@@ -114,61 +143,4 @@ public:
 
 private:
 	std::vector <unsigned int> m_vtxId;
-};
-
-class SUVSet {
-public:
-	SUVSet(){};
-
-	SUVSet(MString &name) {
-		this->name = name;
-	};
-
-	SUVSet(const SUVSet &uvSet) {
-		name = uvSet.name;
-		U = uvSet.U;
-		V = uvSet.U;
-		uvCounts = uvSet.uvCounts;
-		uvIndices = uvSet.uvIndices;
-	};
-
-	SUVSet& operator=(const SUVSet& uvSet) {
-		name = uvSet.name;
-		U = uvSet.U;
-		V = uvSet.U;
-		uvCounts = uvSet.uvCounts;
-		uvIndices = uvSet.uvIndices;
-
-		return *this;
-	}
-
-	~SUVSet() {}
-
-	virtual void addPolygon() {
-		unsigned int currentLength = U.length();
-		
-		U.append(0);
-		U.append(0);
-		U.append(1);
-		U.append(1);
-
-		V.append(0);
-		V.append(1);
-		V.append(1);
-		V.append(0);
-
-		for (unsigned int i = currentLength; i < currentLength + 4; i++)
-			uvIndices.append(i);
-
-		uvCounts.append(4);
-	}
-
-	MString
-		name;
-	MFloatArray
-		U,
-		V;
-	MIntArray
-		uvCounts,
-		uvIndices;
 };
\ No newline at end of file
@@ -0,0 +1,209 @@
+#include "SMeshAdapter.h"
+
+#include <maya\MFloatArray.h>
+#include <maya\MFloatVectorArray.h>
+
+MStatus SMeshAdapter::load(const MObject &mesh, SMeshBuffer &buffer) {
+	MStatus status;
+
+	buffer.clear();
+
+	MFnMesh fnMesh(mesh, &status);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+
+	status = getPoints(mesh, buffer.points);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+
+	MIntArray
+		polyCounts,
+		polyIndices;
+	status = fnMesh.getVertices(polyCounts, polyIndices);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+	toIntVector(polyCounts, buffer.counts);
+	toIntVector(polyIndices, buffer.indices);
+
+	// Current UV set
+	MFloatArray
+		U,
+		V;
+	MIntArray
+		uvCounts,
+		uvIndices;
+	status = fnMesh.getUVs(U, V);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+	status = fnMesh.getAssignedUVs(uvCounts, uvIndices);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+
+	buffer.u.resize(U.length());
+	buffer.v.resize(V.length());
+	U.get(buffer.u.data());
+	V.get(buffer.v.data());
+	toIntVector(uvCounts, buffer.uvCounts);
+	toIntVector(uvIndices, buffer.uvIndices);
+
+	return MS::kSuccess;
+}
+
+MStatus SMeshAdapter::commit(const SMeshBuffer &buffer, MObject &mesh) {
+	MStatus status;
+
+	MFnMesh fnMesh(mesh, &status);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+
+	MPointArray meshPoints;
+	toPointArray(buffer.points, meshPoints);
+
+	if (buffer.isTopologyModified) {
+		MFloatArray
+			U(buffer.u.data(), (unsigned int)buffer.u.size()),
+			V(buffer.v.data(), (unsigned int)buffer.v.size());
+
+		fnMesh.create(
+			meshPoints.length(),
+			(int)buffer.counts.size(),
+			meshPoints,
+			toIntArray(buffer.counts),
+			toIntArray(buffer.indices),
+			U,
+			V,
+			mesh,
+			&status
+		);
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+
+		status = fnMesh.assignUVs(toIntArray(buffer.uvCounts), toIntArray(buffer.uvIndices));
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+	}
+	else if (buffer.arePointsModified) {
+		status = fnMesh.setPoints(meshPoints);
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+	}
+
+	return MS::kSuccess;
+}
+
+MStatus SMeshAdapter::getTopology(const MObject &mesh, SMeshTopology &topology) {
+	MStatus status;
+
+	MFnMesh fnMesh(mesh, &status);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+
+	MIntArray
+		polyCounts,
+		polyIndices;
+	status = fnMesh.getVertices(polyCounts, polyIndices);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+
+	std::vector <int>
+		counts(polyCounts.length()),
+		indices(polyIndices.length()),
+		edgeVertices(2 * fnMesh.numEdges());
+
+	polyCounts.get(counts.data());
+	polyIndices.get(indices.data());
+
+	for (int e = 0; e < fnMesh.numEdges(); e++) {
+		int2 vertices;
+		status = fnMesh.getEdgeVertices(e, vertices);
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+		edgeVertices[2 * e] = vertices[0];
+		edgeVertices[2 * e + 1] = vertices[1];
+	}
+
+	if (!topology.build(fnMesh.numVertices(), counts, indices, edgeVertices))
+		return MS::kFailure;
+
+	return MS::kSuccess;
+}
+
+// Raw float points, transformed only when a matrix is given
+MStatus SMeshAdapter::getPoints(const MObject &mesh, std::vector <SVec3> &points, const MMatrix &transform) {
+	MStatus status;
+
+	MFnMesh fnMesh(mesh, &status);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+
+	const float *rawPoints = fnMesh.getRawPoints(&status);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+
+	unsigned int numVertices = fnMesh.numVertices();
+	points.resize(numVertices);
+
+	bool isIdentity = (transform == MMatrix::identity);
+	for (unsigned int v = 0; v < numVertices; v++) {
+		const float *point = rawPoints + 3 * v;
+		if (isIdentity)
+			points[v] = SVec3(point[0], point[1], point[2]);
+		else
+			points[v] = toVec3(MPoint(point[0], point[1], point[2]) * transform);
+	}
+
+	return MS::kSuccess;
+}
+
+MStatus SMeshAdapter::getVertexNormals(const MObject &mesh, std::vector <SVec3> &normals) {
+	MStatus status;
+
+	MFnMesh fnMesh(mesh, &status);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+
+	MFloatVectorArray vertexNormals;
+	status = fnMesh.getVertexNormals(true, vertexNormals);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+
+	normals.resize(vertexNormals.length());
+	for (unsigned int v = 0; v < vertexNormals.length(); v++)
+		normals[v] = SVec3(vertexNormals[v].x, vertexNormals[v].y, vertexNormals[v].z);
+
+	return MS::kSuccess;
+}
+
+SVec3 SMeshAdapter::toVec3(const MPoint &point) {
+	return SVec3(point.x, point.y, point.z);
+}
+
+SVec3 SMeshAdapter::toVec3(const MVector &vector) {
+	return SVec3(vector.x, vector.y, vector.z);
+}
+
+MPoint SMeshAdapter::toPoint(const SVec3 &vector) {
+	return MPoint(vector.x, vector.y, vector.z);
+}
+
+MVector SMeshAdapter::toVector(const SVec3 &vector) {
+	return MVector(vector.x, vector.y, vector.z);
+}
+
+void SMeshAdapter::toVec3Array(const MPointArray &points, std::vector <SVec3> &vectors) {
+	vectors.resize(points.length());
+	for (unsigned int i = 0; i < points.length(); i++)
+		vectors[i] = toVec3(points[i]);
+}
+
+void SMeshAdapter::toVec3Array(const MVectorArray &vectors, std::vector <SVec3> &result) {
+	result.resize(vectors.length());
+	for (unsigned int i = 0; i < vectors.length(); i++)
+		result[i] = toVec3(vectors[i]);
+}
+
+void SMeshAdapter::toPointArray(const std::vector <SVec3> &vectors, MPointArray &points) {
+	points.setLength((unsigned int)vectors.size());
+	for (unsigned int i = 0; i < vectors.size(); i++)
+		points[i] = toPoint(vectors[i]);
+}
+
+void SMeshAdapter::toVectorArray(const std::vector <SVec3> &vectors, MVectorArray &result) {
+	result.setLength((unsigned int)vectors.size());
+	for (unsigned int i = 0; i < vectors.size(); i++)
+		result[i] = toVector(vectors[i]);
+}
+
+void SMeshAdapter::toIntVector(const MIntArray &array, std::vector <int> &result) {
+	result.resize(array.length());
+	if (0 < array.length())
+		array.get(result.data());
+}
+
+MIntArray SMeshAdapter::toIntArray(const std::vector <int> &values) {
+	return MIntArray(values.data(), (unsigned int)values.size());
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "SMeshBuffer.h"
+#include "SVec3.h"
+
+#include <maya\MObject.h>
+#include <maya\MStatus.h>
+#include <maya\MFnMesh.h>
+#include <maya\MMatrix.h>
+#include <maya\MPoint.h>
+#include <maya\MVector.h>
+#include <maya\MPointArray.h>
+#include <maya\MVectorArray.h>
+#include <maya\MIntArray.h>
+
+#include <vector>
+
+// Conversions between Maya meshes and the Maya independent SMeshBuffer
+class SMeshAdapter
+{
+public:
+	SMeshAdapter() {};
+	~SMeshAdapter() {};
+
+	// Points, faces and the current UV set. Shared normals are left to the caller.
+	static MStatus load(const MObject &mesh, SMeshBuffer &buffer);
+
+	// Rebuilds the mesh when the topology changed, otherwise only writes points
+	static MStatus commit(const SMeshBuffer &buffer, MObject &mesh);
+
+	// Topology keeps the edge numbering of the mesh
+	static MStatus getTopology(const MObject &mesh, SMeshTopology &topology);
+	static MStatus getPoints(const MObject &mesh, std::vector <SVec3> &points, const MMatrix &transform = MMatrix::identity);
+	static MStatus getVertexNormals(const MObject &mesh, std::vector <SVec3> &normals);
+
+	static SVec3 toVec3(const MPoint &point);
+	static SVec3 toVec3(const MVector &vector);
+	static MPoint toPoint(const SVec3 &vector);
+	static MVector toVector(const SVec3 &vector);
+
+	static void toVec3Array(const MPointArray &points, std::vector <SVec3> &vectors);
+	static void toVec3Array(const MVectorArray &vectors, std::vector <SVec3> &result);
+	static void toPointArray(const std::vector <SVec3> &vectors, MPointArray &points);
+	static void toVectorArray(const std::vector <SVec3> &vectors, MVectorArray &result);
+	static void toIntVector(const MIntArray &array, std::vector <int> &result);
+	static MIntArray toIntArray(const std::vector <int> &values);
+};
\ No newline at end of file
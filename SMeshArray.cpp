@@ -0,0 +1,172 @@
+#include "SMeshArray.h"
+
+SMeshArray::SMeshArray() {
+	m_numThreads = SParallel::numThreads();
+}
+
+SMeshArray::SMeshArray(const MObjectArray &meshes, MStatus *ref) {
+	MStatus status;
+
+	m_numThreads = SParallel::numThreads();
+
+	m_meshes.reserve(meshes.length());
+	m_status.reserve(meshes.length());
+	for (unsigned int i = 0; i < meshes.length(); i++) {
+		MObject mesh = meshes[i];
+		status = append(mesh);
+		if (status != MS::kSuccess)
+			break;
+	}
+
+	if (ref != NULL)
+		*ref = status;
+}
+
+SMeshArray::~SMeshArray() {}
+
+MStatus SMeshArray::append(MObject &mesh) {
+	MStatus status;
+
+	SSeamMesh seamMesh(mesh, &status);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+
+	append(seamMesh);
+
+	return MS::kSuccess;
+}
+
+void SMeshArray::append(const SSeamMesh &mesh) {
+	m_meshes.push_back(std::unique_ptr<SSeamMesh>(new SSeamMesh(mesh)));
+	m_status.push_back(MS::kSuccess);
+}
+
+void SMeshArray::clear() {
+	m_meshes.clear();
+	m_status.clear();
+}
+
+unsigned int SMeshArray::length() const {
+	return (unsigned int)m_meshes.size();
+}
+
+SSeamMesh &SMeshArray::operator[](const unsigned int index) {
+	return *m_meshes[index];
+}
+
+void SMeshArray::setNumThreads(unsigned int threads) {
+	m_numThreads = (0 < threads) ? threads : SParallel::numThreads();
+}
+
+unsigned int SMeshArray::numThreads() const {
+	return m_numThreads;
+}
+
+MStatus SMeshArray::status(const unsigned int index) const {
+	if (m_status.size() <= index)
+		return MS::kInvalidParameter;
+	return m_status[index];
+}
+
+const std::vector <MStatus> &SMeshArray::statuses() const {
+	return m_status;
+}
+
+void SMeshArray::getObjects(MObjectArray &meshes) const {
+	meshes.clear();
+	for (auto &mesh : m_meshes)
+		meshes.append(mesh->getObject());
+}
+
+MStatus SMeshArray::detachEdges(const std::vector <MIntArray> &edges) {
+	if (edges.size() != m_meshes.size())
+		return MS::kInvalidParameter;
+
+	std::vector <std::vector <int>> edgeIds(m_meshes.size());
+	for (unsigned int i = 0; i < m_meshes.size(); i++)
+		SMeshAdapter::toIntVector(edges[i], edgeIds[i]);
+
+	// Shared normals are read from Maya before the buffers are handed to the pool
+	return forEach([](SSeamMesh &mesh, unsigned int) {
+		MStatus status = mesh.beginEdit();
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+		return mesh.loadVertexNormals();
+	}, [&](SSeamMesh &mesh, unsigned int index) {
+		return mesh.m_buffer.detachEdges(edgeIds[index], mesh.m_vtxMap, mesh.m_vtxSplitValence) ? MS::kSuccess : MS::kInvalidParameter;
+	}, [](SSeamMesh &mesh, unsigned int, MStatus status) {
+		if (!mesh.isEditing())
+			return status;
+		return mesh.endEdit(true, status);
+	});
+}
+
+MStatus SMeshArray::setActiveEdges(const std::vector <MIntArray> &edges) {
+	if (edges.size() != m_meshes.size())
+		return MS::kInvalidParameter;
+
+	std::vector <std::vector <int>> edgeIds(m_meshes.size());
+	std::vector <const SMeshTopology *> topologies(m_meshes.size(), NULL);
+	return forEach([&](SSeamMesh &mesh, unsigned int index) {
+		MStatus status;
+		mesh.m_activeLoops.clear();
+		topologies[index] = &mesh.topology(&status);
+		SMeshAdapter::toIntVector(edges[index], edgeIds[index]);
+		return status;
+	}, [&](SSeamMesh &mesh, unsigned int index) {
+		return mesh.buildActiveLoops(*topologies[index], edgeIds[index]);
+	}, [](SSeamMesh &, unsigned int, MStatus status) {
+		return status;
+	});
+}
+
+// Loops are offset on the edit buffer, the mesh is rebuilt once per mesh at the end
+MStatus SMeshArray::offsetEdgeloops(float offsetDistance, bool createPolygons) {
+	return editEach([&](SSeamMesh &mesh, unsigned int) {
+		return mesh.offsetEdgeloops(offsetDistance, createPolygons);
+	});
+}
+
+MStatus SMeshArray::extrudeEdges(const std::vector <MIntArray> &edges, const float thickness, const unsigned int divisions) {
+	if (edges.size() != m_meshes.size())
+		return MS::kInvalidParameter;
+
+	std::vector <std::vector <int>> edgeIds(m_meshes.size());
+	for (unsigned int i = 0; i < m_meshes.size(); i++)
+		SMeshAdapter::toIntVector(edges[i], edgeIds[i]);
+
+	return editEach([&](SSeamMesh &mesh, unsigned int index) {
+		return mesh.m_buffer.extrudeEdges(edgeIds[index], thickness, divisions) ? MS::kSuccess : MS::kInvalidParameter;
+	});
+}
+
+// Elements are read and groups created on the calling thread, only the grouping runs on the pool
+MStatus SMeshArray::groupConnectedComponents(const MObjectArray &components, std::vector <MObjectArray> &componentGroups) {
+	if (components.length() != m_meshes.size())
+		return MS::kInvalidParameter;
+
+	componentGroups.assign(m_meshes.size(), MObjectArray());
+
+	std::vector <std::vector <int>>
+		elements(m_meshes.size()),
+		groupOffsets(m_meshes.size()),
+		groupedElements(m_meshes.size());
+	std::vector <const SMeshTopology *> topologies(m_meshes.size(), NULL);
+	std::vector <MFn::Type> types(m_meshes.size(), MFn::kInvalid);
+	return forEach([&](SSeamMesh &mesh, unsigned int index) {
+		MStatus status;
+
+		types[index] = components[index].apiType();
+		MFnSingleIndexedComponent fnComponent(components[index], &status);
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+		MIntArray compIndices;
+		fnComponent.getElements(compIndices);
+		SMeshAdapter::toIntVector(compIndices, elements[index]);
+
+		topologies[index] = &mesh.topology(&status);
+		return status;
+	}, [&](SSeamMesh &mesh, unsigned int index) {
+		return mesh.groupElements(*topologies[index], types[index], elements[index], groupOffsets[index], groupedElements[index]);
+	}, [&](SSeamMesh &, unsigned int index, MStatus status) {
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+		return SMesh::createComponentGroups(types[index], groupOffsets[index], groupedElements[index], componentGroups[index]);
+	});
+}
\ No newline at end of file
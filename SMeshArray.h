@@ -0,0 +1,92 @@
+#pragma once
+
+#include "SSeamMesh.h"
+#include "SParallel.h"
+
+#include <maya\MObject.h>
+#include <maya\MObjectArray.h>
+#include <maya\MStatus.h>
+#include <maya\MIntArray.h>
+
+#include <vector>
+#include <memory>
+
+// Batch of independent meshes processed on a thread pool. The Maya API is not safe to use from
+// several threads, so every batch call loads and commits meshes on the calling thread and only
+// runs the Maya independent buffer and topology kernels on the pool. Kernels run serially on
+// their pool thread, SParallel does not nest. Status is kept per mesh, the batch calls return
+// kFailure when any mesh failed.
+//
+// Every appended mesh is copied once, the batch calls edit the copies and leave the caller's
+// meshes untouched. Results have to be read back through getObjects or operator[].
+class SMeshArray
+{
+public:
+	SMeshArray();
+	SMeshArray(const MObjectArray &meshes, MStatus *ref = NULL);
+	~SMeshArray();
+
+	MStatus			append(MObject &mesh);
+	void			append(const SSeamMesh &mesh);
+	void			clear();
+	unsigned int	length() const;
+	SSeamMesh		&operator[](const unsigned int index);
+
+	void			setNumThreads(unsigned int threads);
+	unsigned int	numThreads() const;
+
+	MStatus			status(const unsigned int index) const;
+	const std::vector <MStatus> &statuses() const;
+	void			getObjects(MObjectArray &meshes) const;
+
+	// Per mesh arguments are indexed like the meshes
+	MStatus			detachEdges(const std::vector <MIntArray> &edges);
+	MStatus			setActiveEdges(const std::vector <MIntArray> &edges);
+	MStatus			offsetEdgeloops(float offsetDistance, bool createPolygons = true);
+	MStatus			extrudeEdges(const std::vector <MIntArray> &edges, const float thickness, const unsigned int divisions);
+	MStatus			groupConnectedComponents(const MObjectArray &components, std::vector <MObjectArray> &componentGroups);
+
+	// Runs prepare(mesh, index) for every mesh on the calling thread, then compute(mesh, index) on
+	// the pool for the meshes that were prepared, then finish(mesh, index, status) on the calling
+	// thread again. Only prepare and finish may call into Maya, each step returns the status of
+	// the mesh.
+	template <typename Prepare, typename Compute, typename Finish>
+	MStatus forEach(Prepare prepare, Compute compute, Finish finish) {
+		m_status.assign(m_meshes.size(), MS::kSuccess);
+
+		for (unsigned int i = 0; i < m_meshes.size(); i++)
+			m_status[i] = prepare(*m_meshes[i], i);
+
+		SParallel::forEach((unsigned int)m_meshes.size(), m_numThreads, [&](unsigned int index) {
+			if (m_status[index] == MS::kSuccess)
+				m_status[index] = compute(*m_meshes[index], index);
+		});
+
+		for (unsigned int i = 0; i < m_meshes.size(); i++)
+			m_status[i] = finish(*m_meshes[i], i, m_status[i]);
+
+		for (auto &meshStatus : m_status)
+			if (meshStatus != MS::kSuccess)
+				return MS::kFailure;
+		return MS::kSuccess;
+	};
+
+	// Edit of every mesh, compute(mesh, index) only works on the edit buffer. Edits are committed
+	// when compute succeeds and cancelled otherwise.
+	template <typename Compute>
+	MStatus editEach(Compute compute) {
+		return forEach([](SSeamMesh &mesh, unsigned int) {
+			return mesh.beginEdit();
+		}, compute, [](SSeamMesh &mesh, unsigned int, MStatus status) {
+			if (!mesh.isEditing())
+				return status;
+			return mesh.endEdit(true, status);
+		});
+	};
+
+protected:
+	// Meshes are held by pointer, growing the array never copies mesh data through Maya
+	std::vector <std::unique_ptr<SSeamMesh>> m_meshes;
+	std::vector <MStatus> m_status;
+	unsigned int m_numThreads;
+};
\ No newline at end of file
@@ -0,0 +1,700 @@
+#include "SMeshBuffer.h"
+#include "SParallel.h"
+
+#include <map>
+#include <unordered_map>
+
+SMeshBuffer::SMeshBuffer() {}
+
+SMeshBuffer::~SMeshBuffer() {}
+
+void SMeshBuffer::clear() {
+	points.clear();
+	normals.clear();
+	vertexNormals.clear();
+	counts.clear();
+	indices.clear();
+	u.clear();
+	v.clear();
+	uvCounts.clear();
+	uvIndices.clear();
+
+	hasVertexNormals = false;
+	isTopologyModified = false;
+	arePointsModified = false;
+	areNormalsModified = false;
+
+	m_topology.clear();
+	m_isTopologyDirty = true;
+}
+
+unsigned int SMeshBuffer::numVertices() const {
+	return (unsigned int)points.size();
+}
+
+unsigned int SMeshBuffer::numFaces() const {
+	return (unsigned int)counts.size();
+}
+
+bool SMeshBuffer::isModified() const {
+	return isTopologyModified || arePointsModified || areNormalsModified;
+}
+
+const SMeshTopology &SMeshBuffer::topology() {
+	if (m_isTopologyDirty)
+		m_isTopologyDirty = !m_topology.build(numVertices(), counts, indices);
+	return m_topology;
+}
+
+void SMeshBuffer::setTopology(const SMeshTopology &topology) {
+	m_topology = topology;
+	m_isTopologyDirty = false;
+}
+
+void SMeshBuffer::invalidateTopology() {
+	m_isTopologyDirty = true;
+}
+
+// Newell's method handles non-planar polygons
+SVec3 SMeshBuffer::polygonNormal(const int *polygon, const unsigned int count) const {
+	SVec3 normal;
+	for (unsigned int k = 0; k < count; k++) {
+		const SVec3
+			&A = points[polygon[k]],
+			&B = points[polygon[(k + 1) % count]];
+		normal.x += (A.y - B.y) * (A.z + B.z);
+		normal.y += (A.z - B.z) * (A.x + B.x);
+		normal.z += (A.x - B.x) * (A.y + B.y);
+	}
+	return normal.normal();
+}
+
+void SMeshBuffer::computeFaceNormals(std::vector <SVec3> &faceNormals) {
+	const SMeshTopology &meshTopology = topology();
+	unsigned int numFaces = meshTopology.numFaces();
+	faceNormals.resize(numFaces);
+
+	SParallel::forChunks(numFaces, SParallel::numChunks(numFaces, 1 << 14), [&](unsigned int, unsigned int begin, unsigned int end) {
+		for (unsigned int face = begin; face < end; face++)
+			faceNormals[face] = polygonNormal(meshTopology.faceVertices(face), meshTopology.faceCount(face));
+	});
+}
+
+// Angle weighted average of face normals
+void SMeshBuffer::computeVertexNormals(std::vector <SVec3> &normals) const {
+	normals.assign(points.size(), SVec3());
+
+	unsigned int offset = 0;
+	for (unsigned int f = 0; f < counts.size(); f++) {
+		unsigned int count = counts[f];
+		SVec3 faceNormal = polygonNormal(&indices[offset], count);
+
+		for (unsigned int k = 0; k < count; k++) {
+			int
+				vertex = indices[offset + k],
+				next = indices[offset + (k + 1) % count],
+				previous = indices[offset + (k + count - 1) % count];
+			SVec3
+				toNext = points[next] - points[vertex],
+				toPrevious = points[previous] - points[vertex];
+			normals[vertex] += faceNormal * toNext.angle(toPrevious);
+		}
+
+		offset += count;
+	}
+
+	for (auto &normal : normals)
+		normal = normal.normal();
+}
+
+void SMeshBuffer::updateVertexNormals() {
+	if (hasVertexNormals && vertexNormals.size() == points.size())
+		return;
+
+	computeVertexNormals(vertexNormals);
+	hasVertexNormals = true;
+}
+
+// Unit square UVs for a new quad
+void SMeshBuffer::addPolygonUVs() {
+	unsigned int currentLength = (unsigned int)u.size();
+
+	const float
+		squareU[4] = { 0, 0, 1, 1 },
+		squareV[4] = { 0, 1, 1, 0 };
+	for (unsigned int i = 0; i < 4; i++) {
+		u.push_back(squareU[i]);
+		v.push_back(squareV[i]);
+		uvIndices.push_back(currentLength + i);
+	}
+
+	uvCounts.push_back(4);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Editing kernels ////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool SMeshBuffer::detachEdges(const std::vector <int> &edges, std::vector <unsigned int> &vtxMap, std::vector <unsigned int> &vtxSplitValence) {
+	const SMeshTopology &meshTopology = topology();
+	if (meshTopology.isNull())
+		return false;
+
+	// Put edges in bitmap for faster search
+	std::vector <bool> detachedEdges(meshTopology.numEdges(), false);
+	for (auto &edge : edges) {
+		if (edge < 0 || meshTopology.numEdges() <= (unsigned int)edge)
+			return false;
+		detachedEdges[edge] = true;
+	}
+
+	updateVertexNormals();
+
+	unsigned int numVertices = meshTopology.numVertices();
+	unsigned int chunks = SParallel::numChunks(numVertices, 1 << 14);
+
+	// First pass counts new vertices. Faces are stored between their edges in winding order,
+	// every crossed split edge after the first face starts a new vertex.
+	std::vector <int>
+		startEdges(numVertices, -1),
+		numSplits(numVertices, 0);
+	std::vector <unsigned int>
+		newVertexOffsets(numVertices + 1, 0);
+
+	SParallel::forChunks(numVertices, chunks, [&](unsigned int, unsigned int begin, unsigned int end) {
+		for (unsigned int vertex = begin; vertex < end; vertex++) {
+			const int *conEdges = meshTopology.connectedEdges(vertex);
+			int
+				numEdges = meshTopology.numConnectedEdges(vertex),
+				numFaces = meshTopology.numConnectedFaces(vertex);
+			bool onBoundary = meshTopology.onBoundary(vertex);
+
+			// Find the first split edge connected to current vertex. And total splits
+			for (int e = 0; e < numEdges; e++) {
+				if (detachedEdges[conEdges[e]]) {
+					if (startEdges[vertex] < 0)
+						startEdges[vertex] = e;
+					numSplits[vertex]++;
+				}
+			}
+			if (onBoundary)
+				startEdges[vertex] = 0;
+
+			// Skip interior vertices with only one split and vertices without split
+			if ((numSplits[vertex] == 1 && !onBoundary) || numSplits[vertex] == 0) {
+				numSplits[vertex] = 0;
+				continue;
+			}
+
+			for (int f = 1; f < numFaces; f++)
+				if (detachedEdges[conEdges[(startEdges[vertex] + f) % numFaces]])
+					newVertexOffsets[vertex + 1]++;
+		}
+	});
+
+	// Exclusive prefix sum assigns new ids in vertex order
+	for (unsigned int v = 0; v < numVertices; v++)
+		newVertexOffsets[v + 1] += newVertexOffsets[v];
+	unsigned int numNewVertices = newVertexOffsets[numVertices];
+
+	vtxMap.resize(numVertices + numNewVertices, 0);
+	vtxSplitValence.resize(numVertices + numNewVertices, 0);
+
+	// Second pass replaces old vertices with new ones in faces around every split vertex. The
+	// topology keeps the source indices.
+	SParallel::forChunks(numVertices, chunks, [&](unsigned int, unsigned int begin, unsigned int end) {
+		for (unsigned int vertex = begin; vertex < end; vertex++) {
+			if (numSplits[vertex] == 0)
+				continue;
+
+			const int
+				*conEdges = meshTopology.connectedEdges(vertex),
+				*conFaces = meshTopology.connectedFaces(vertex);
+			int numFaces = meshTopology.numConnectedFaces(vertex);
+
+			unsigned int
+				newVtxId = vertex,
+				nextVtxId = numVertices + newVertexOffsets[vertex];
+
+			for (int f = 0; f < numFaces; f++) {
+				int relativeIdx = (startEdges[vertex] + f) % numFaces;
+				if (f != 0 && detachedEdges[conEdges[relativeIdx]]) {
+					newVtxId = nextVtxId++;
+					vtxMap[newVtxId] = vertex;
+				}
+				if (newVtxId != vertex) {
+					unsigned int face = conFaces[relativeIdx], offset = meshTopology.faceOffset(face);
+					const int *faceVertices = meshTopology.faceVertices(face);
+					for (unsigned int i = 0; i < meshTopology.faceCount(face); i++)
+						if (faceVertices[i] == (int)vertex) {
+							indices[offset + i] = newVtxId;
+							break;
+						}
+				}
+				vtxSplitValence[newVtxId] = numSplits[vertex];
+			}
+		}
+	});
+
+	// New vertices copy position and normal of their source vertex
+	points.resize(numVertices + numNewVertices);
+	vertexNormals.resize(numVertices + numNewVertices);
+	for (unsigned int v = numVertices; v < numVertices + numNewVertices; v++) {
+		points[v] = points[vtxMap[v]];
+		vertexNormals[v] = vertexNormals[vtxMap[v]];
+	}
+
+	// Shared normals used for parallel flanges etc.
+	normals = vertexNormals;
+
+	// UVs stay assigned per face-vertex, the buffer only gained vertices
+	isTopologyModified = true;
+	arePointsModified = true;
+	areNormalsModified = true;
+	invalidateTopology();
+
+	return true;
+}
+
+bool SMeshBuffer::extrudeEdges(const std::vector <int> &edges, const float thickness, const unsigned int divisions) {
+	const SMeshTopology &meshTopology = topology();
+	if (meshTopology.isNull() || normals.size() < points.size())
+		return false;
+
+	for (auto &edge : edges)
+		if (edge < 0 || meshTopology.numEdges() <= (unsigned int)edge)
+			return false;
+
+	unsigned int numSegments = divisions + 1;
+	float divisionThickness = thickness / numSegments;
+
+	// <division level <original id, extruded id>
+	std::vector <std::map <unsigned int, unsigned int>> mapIds(numSegments);
+
+	for (auto &edge : edges) {
+		int vertices[2];
+		meshTopology.getEdgeVertices(edge, vertices);
+
+		for (unsigned int d = 0; d < numSegments; d++) {
+			// Start polygon with original vertices
+			for (unsigned int i = 0; i < 2; i++) {
+				int vtxId = vertices[(i == 0) ? 1 : 0];
+				int divVtxId = (d == 0) ? vtxId : mapIds[d - 1][vtxId];
+				indices.push_back(divVtxId);
+			}
+
+			// Complete polygon with extruded vertices
+			for (unsigned int i = 0; i < 2; i++) {
+				int vtxId = vertices[i];
+
+				// Define new vertex if necessary
+				if (mapIds[d].find(vtxId) == mapIds[d].end()) {
+					float extDistance = (d + 1)*divisionThickness*(-1);
+					SVec3 extrudedPoint = points[vtxId] + normals[vtxId] * extDistance;
+					mapIds[d][vtxId] = (unsigned int)points.size();
+					points.push_back(extrudedPoint);
+				}
+				indices.push_back(mapIds[d][vtxId]);
+			}
+			counts.push_back(4);
+			addPolygonUVs();
+		}
+	}
+
+	isTopologyModified = true;
+	arePointsModified = true;
+	hasVertexNormals = false;
+	invalidateTopology();
+
+	return true;
+}
+
+bool SMeshBuffer::pullVertices(const std::vector <int> &vertices, const float distance) {
+	for (auto &vertex : vertices)
+		if (vertex < 0 || points.size() <= (unsigned int)vertex || normals.size() <= (unsigned int)vertex)
+			return false;
+
+	std::vector <bool> done(points.size(), false);
+	for (auto &vertex : vertices)
+		if (!done[vertex]) {
+			points[vertex] += normals[vertex] * distance;
+			done[vertex] = true;
+		}
+
+	arePointsModified = true;
+	hasVertexNormals = false;
+
+	return true;
+}
+
+// Face-vertex normals for hard edges. A vertex is split when it has at least two hard edges
+// with faces meeting at no more than the threshold angle, or one on the boundary. Every fan of
+// faces between hard edges then gets the average of their normals.
+bool SMeshBuffer::hardEdgeNormals(const std::vector <int> &edges, const double thresholdAngle, std::vector <int> &faceIds, std::vector <int> &vertexIds, std::vector <SVec3> &faceVertexNormals) {
+	faceIds.clear();
+	vertexIds.clear();
+	faceVertexNormals.clear();
+
+	const SMeshTopology &meshTopology = topology();
+	if (meshTopology.isNull())
+		return false;
+
+	std::vector <SVec3> faceNormals;
+	computeFaceNormals(faceNormals);
+
+	// Interior angle pi - acos(dot) <= threshold, compared on the dot product
+	double maxDot = -std::cos(thresholdAngle);
+
+	std::vector <bool>
+		hardEdges(meshTopology.numEdges(), false),
+		splitEdges(meshTopology.numEdges(), false);
+	for (auto &edge : edges) {
+		if (edge < 0 || meshTopology.numEdges() <= (unsigned int)edge)
+			return false;
+		hardEdges[edge] = true;
+
+		if (meshTopology.numEdgeFaces(edge) != 2)
+			continue;
+		const int *edgeFaces = meshTopology.edgeFaces(edge);
+		splitEdges[edge] = faceNormals[edgeFaces[0]].dot(faceNormals[edgeFaces[1]]) <= maxDot;
+	}
+
+	// Chunks collect their own results, concatenated in vertex order afterwards
+	unsigned int numVertices = meshTopology.numVertices();
+	unsigned int chunks = SParallel::numChunks(numVertices, 1 << 14);
+	std::vector <std::vector<int>>
+		chunkFaces(chunks),
+		chunkVertices(chunks);
+	std::vector <std::vector<SVec3>> chunkNormals(chunks);
+
+	SParallel::forChunks(numVertices, chunks, [&](unsigned int chunk, unsigned int begin, unsigned int end) {
+		std::vector <int> fan;
+		for (unsigned int vertex = begin; vertex < end; vertex++) {
+			const int
+				*conEdges = meshTopology.connectedEdges(vertex),
+				*conFaces = meshTopology.connectedFaces(vertex);
+			int
+				numEdges = meshTopology.numConnectedEdges(vertex),
+				numFaces = meshTopology.numConnectedFaces(vertex),
+				startEdge = -1,
+				numSplits = 0;
+			bool onBoundary = meshTopology.onBoundary(vertex);
+
+			for (int e = 0; e < numEdges; e++)
+				if (splitEdges[conEdges[e]]) {
+					if (startEdge < 0)
+						startEdge = e;
+					numSplits++;
+				}
+			if (onBoundary)
+				startEdge = 0;
+
+			if ((numSplits == 1 && !onBoundary) || numSplits == 0)
+				continue;
+
+			SVec3 average;
+			fan.clear();
+			for (int f = 0; f <= numFaces; f++) {
+				int relativeIdx = (startEdge + f) % numFaces;
+
+				if (f == numFaces || (f != 0 && hardEdges[conEdges[relativeIdx]])) {
+					average = average.normal();
+					for (auto &face : fan) {
+						chunkFaces[chunk].push_back(face);
+						chunkVertices[chunk].push_back(vertex);
+						chunkNormals[chunk].push_back(average);
+					}
+					average = SVec3();
+					fan.clear();
+				}
+				if (f == numFaces)
+					break;
+
+				average += faceNormals[conFaces[relativeIdx]];
+				fan.push_back(conFaces[relativeIdx]);
+			}
+		}
+	});
+
+	for (unsigned int c = 0; c < chunks; c++) {
+		faceIds.insert(faceIds.end(), chunkFaces[c].begin(), chunkFaces[c].end());
+		vertexIds.insert(vertexIds.end(), chunkVertices[c].begin(), chunkVertices[c].end());
+		faceVertexNormals.insert(faceVertexNormals.end(), chunkNormals[c].begin(), chunkNormals[c].end());
+	}
+
+	return true;
+}
+
+// Everything offsetting one loop adds to the buffer. New vertices are numbered locally and
+// encoded as -1 - index in the face list, new edge ids start at zero. Both are shifted once the
+// loop's place in the batch is known.
+struct SLoopPolygons
+{
+	std::unordered_map <int, SVec3> displacements;
+	std::vector <SVec3>
+		newPoints,
+		newNormals;
+	std::vector <int> faceIndices;
+	unsigned int numNewEdges = 0;
+	SLoopOffset offset;
+};
+
+static int newVertex(unsigned int index) {
+	return -1 - (int)index;
+}
+
+// Reads the buffer only, so independent loops can run side by side
+static bool computeLoopOffset(const SMeshTopology &meshTopology, const std::vector<SVec3> &points, const std::vector<SVec3> &normals, const std::vector <unsigned int> &loopEdges, const float offsetDistance, const bool createPolygons, SLoopPolygons &result) {
+	SLoopOffset &offset = result.offset;
+	offset.edges = loopEdges;
+
+	if (loopEdges.size() == 0)
+		return false;
+
+	int numEdges = meshTopology.numEdges();
+
+	if (createPolygons && normals.size() != meshTopology.numVertices())
+		return false;
+
+	for (auto &edge : loopEdges) {
+		if (numEdges <= (int)edge)
+			return false;
+		int vertices[2];
+		meshTopology.getEdgeVertices(edge, vertices);
+		if (!meshTopology.onBoundary(vertices[0]) || !meshTopology.onBoundary(vertices[1]))
+			return false;
+	}
+
+	// Offset directions are measured on the points as they were before this loop moved them
+	auto getEdgeVector = [&](int edge, int fromVertex) {
+		int vertices[2];
+		meshTopology.getEdgeVertices(edge, vertices);
+		const SVec3
+			&A = points[vertices[0]],
+			&B = points[vertices[1]];
+		return (fromVertex == vertices[0]) ? B - A : A - B;
+	};
+
+	bool isClosedEnd = false;
+	bool isCrossedEnd = false;
+	int firstVtxId = -1;
+	unsigned int numLoopEdges = (unsigned int)loopEdges.size();
+	unsigned int lastElement = numLoopEdges - 1;
+	SVec3 tmpFirstPoint;
+
+	for (unsigned int l = 0; l < numLoopEdges; l++) {
+
+		int vertices[2];
+		meshTopology.getEdgeVertices(loopEdges[l], vertices);
+
+		bool isLast = false;
+
+		// Duplicate and move original point
+		for (int v = (l == 0) ? 0 : 1; v < 2; v++) {
+			bool isFirst = (l == 0 && v == 0);
+			isLast = (l == lastElement && v == 1);
+
+			int vtxId = vertices[v];
+
+			const int *conEdges = meshTopology.connectedEdges(vtxId);
+			unsigned int numConEdges = meshTopology.numConnectedEdges(vtxId);
+
+			if (isFirst && 1 < numLoopEdges && 0 <= meshTopology.relativeEdgeIndex(vtxId, loopEdges[lastElement])) {
+				if (numConEdges == 2)
+					isCrossedEnd = true;
+				else
+					isClosedEnd = true;
+			}
+
+			if (isLast && isClosedEnd)
+				break;
+
+			SVec3 &displacement = result.displacements[vtxId];
+
+			if (createPolygons) {
+				SVec3 newPoint = points[vtxId] + displacement;
+
+				if (isCrossedEnd && isFirst) {
+					tmpFirstPoint = newPoint;
+					firstVtxId = vtxId;
+					SVec3 direction = getEdgeVector(conEdges[0], vtxId).normal();
+					newPoint += direction*offsetDistance;
+				}
+
+				result.newPoints.push_back(newPoint);
+				result.newNormals.push_back(normals[vtxId]);
+			}
+
+			SVec3 direction;
+			if (isFirst && !isClosedEnd)
+				direction = getEdgeVector(conEdges[numConEdges - 1], vtxId).normal();
+			else if (isLast && !isClosedEnd)
+				direction = getEdgeVector(conEdges[0], vtxId).normal();
+			else
+				for (unsigned int e = 1; e < numConEdges - 1; e++)
+					direction += getEdgeVector(conEdges[e], vtxId).normal();
+			displacement += direction.normal()*offsetDistance;
+
+			// Connected loops continue along the new side edges
+			if (createPolygons && !isClosedEnd && !isCrossedEnd) {
+				if (isFirst) {
+					offset.firstOuterEdge = conEdges[numConEdges - 1];
+					offset.firstNewEdge = 0;
+				}
+				if (isLast) {
+					offset.lastOuterEdge = conEdges[0];
+					offset.lastNewEdge = 2 * numLoopEdges;
+				}
+			}
+		}
+
+		if (createPolygons) {
+			// Define new polygon
+			result.faceIndices.push_back(vertices[0]);
+			result.faceIndices.push_back(newVertex(l));
+			result.faceIndices.push_back((isLast && isClosedEnd) ? newVertex(0) : newVertex(l + 1));
+			result.faceIndices.push_back(vertices[1]);
+
+			// New faces come last, create numbers their edges after the existing ones
+			offset.edges[l] = 2 * l + 1;
+		}
+	}
+
+	if (!createPolygons)
+		return true;
+
+	result.numNewEdges = 2 * numLoopEdges + (isClosedEnd ? 0 : 1);
+
+	if (isCrossedEnd) {
+		unsigned int numNewPoints = (unsigned int)result.newPoints.size();
+		result.faceIndices.push_back(newVertex(numNewPoints - 1));
+		result.faceIndices.push_back(newVertex(numNewPoints));
+		result.faceIndices.push_back(newVertex(0));
+		result.faceIndices.push_back(firstVtxId);
+
+		result.newPoints.push_back(tmpFirstPoint);
+		result.newNormals.push_back(normals[firstVtxId]);
+
+		offset.frontEdge = 2 * numLoopEdges + 2;
+		offset.backEdge = 2 * numLoopEdges + 1;
+		result.numNewEdges += 2;
+	}
+
+	return true;
+}
+
+// Loops touching each other's vertices or their neighbours read points the other one moves,
+// they have to run one after the other
+unsigned int SMeshBuffer::independentLoops(const std::vector <std::vector<unsigned int>> &loops, const unsigned int begin) {
+	const SMeshTopology &meshTopology = topology();
+	if (meshTopology.isNull() || loops.size() <= begin)
+		return begin;
+
+	std::vector <bool> isTaken(meshTopology.numVertices(), false);
+	unsigned int end = begin;
+	for (; end < loops.size(); end++) {
+		bool isIndependent = true;
+		for (auto &edge : loops[end]) {
+			if (meshTopology.numEdges() <= edge)
+				return std::max(end, begin + 1);
+
+			for (unsigned int v = 0; v < 2 && isIndependent; v++) {
+				int vertex = meshTopology.edgeVertex(edge, v);
+				isIndependent = !isTaken[vertex];
+				const int *conEdges = meshTopology.connectedEdges(vertex);
+				for (unsigned int e = 0; e < meshTopology.numConnectedEdges(vertex) && isIndependent; e++)
+					isIndependent = !isTaken[meshTopology.oppositeVertex(vertex, conEdges[e])];
+			}
+			if (!isIndependent)
+				break;
+		}
+		if (!isIndependent)
+			break;
+
+		for (auto &edge : loops[end]) {
+			isTaken[meshTopology.edgeVertex(edge, 0)] = true;
+			isTaken[meshTopology.edgeVertex(edge, 1)] = true;
+		}
+	}
+
+	return end;
+}
+
+bool SMeshBuffer::offsetEdgeloop(const std::vector <unsigned int> &loopEdges, const float offsetDistance, const bool createPolygons, SLoopOffset &offset) {
+	std::vector <SLoopOffset> offsets;
+	if (!offsetEdgeloops(std::vector<std::vector<unsigned int>>(1, loopEdges), 0, 1, offsetDistance, createPolygons, offsets))
+		return false;
+
+	offset = offsets[0];
+	return true;
+}
+
+// Loops are computed in parallel against the unchanged buffer, then their points and polygons
+// are appended in loop order so vertex and edge numbering matches offsetting them one by one
+bool SMeshBuffer::offsetEdgeloops(const std::vector <std::vector<unsigned int>> &loops, const unsigned int begin, const unsigned int end, const float offsetDistance, const bool createPolygons, std::vector <SLoopOffset> &offsets) {
+	offsets.clear();
+
+	const SMeshTopology &meshTopology = topology();
+	if (meshTopology.isNull() || end <= begin || loops.size() < end)
+		return false;
+	if (independentLoops(loops, begin) < end)
+		return false;
+
+	unsigned int numLoops = end - begin;
+	unsigned int totalEdges = 0;
+	for (unsigned int l = begin; l < end; l++)
+		totalEdges += (unsigned int)loops[l].size();
+
+	std::vector <SLoopPolygons> results(numLoops);
+	std::vector <char> isValid(numLoops, 0);
+	SParallel::forEach(numLoops, SParallel::numChunks(totalEdges, 1 << 10), [&](unsigned int l) {
+		isValid[l] = computeLoopOffset(meshTopology, points, normals, loops[begin + l], offsetDistance, createPolygons, results[l]);
+	});
+	for (auto &valid : isValid)
+		if (!valid)
+			return false;
+
+	unsigned int edgeBase = meshTopology.numEdges();
+	offsets.resize(numLoops);
+	for (unsigned int l = 0; l < numLoops; l++) {
+		SLoopPolygons &result = results[l];
+
+		for (auto &displacement : result.displacements)
+			points[displacement.first] += displacement.second;
+
+		if (createPolygons) {
+			int vertexBase = (int)points.size();
+			points.insert(points.end(), result.newPoints.begin(), result.newPoints.end());
+			normals.insert(normals.end(), result.newNormals.begin(), result.newNormals.end());
+
+			for (unsigned int i = 0; i < result.faceIndices.size(); i++) {
+				int index = result.faceIndices[i];
+				indices.push_back((index < 0) ? vertexBase - 1 - index : index);
+				if (i % 4 == 3) {
+					counts.push_back(4);
+					addPolygonUVs();
+				}
+			}
+
+			SLoopOffset &offset = result.offset;
+			for (auto &edge : offset.edges)
+				edge += edgeBase;
+			for (int *edge : { &offset.frontEdge, &offset.backEdge, &offset.firstNewEdge, &offset.lastNewEdge })
+				if (0 <= *edge)
+					*edge += edgeBase;
+			edgeBase += result.numNewEdges;
+		}
+
+		offsets[l] = result.offset;
+	}
+
+	if (createPolygons) {
+		isTopologyModified = true;
+		areNormalsModified = true;
+		invalidateTopology();
+	}
+	arePointsModified = true;
+	hasVertexNormals = false;
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "SVec3.h"
+#include "SMeshTopology.h"
+
+#include <vector>
+
+// Outcome of offsetting one edge loop. The caller applies it to its loops.
+struct SLoopOffset
+{
+	// New ids of the loop edges
+	std::vector <unsigned int> edges;
+
+	// Edges added in front of and behind a loop whose ends cross, -1 when there are none
+	int
+		frontEdge = -1,
+		backEdge = -1;
+
+	// Boundary edges continuing the loop past its ends and the new edges loops holding them
+	// grow by, -1 when the ends are closed
+	int
+		firstOuterEdge = -1,
+		lastOuterEdge = -1,
+		firstNewEdge = -1,
+		lastNewEdge = -1;
+};
+
+// In-memory, Maya independent mesh: points, faces, UVs and shared normals with a lazily built
+// topology. Editing kernels work on the buffer alone, SMeshAdapter converts to and from MObject.
+class SMeshBuffer
+{
+public:
+	SMeshBuffer();
+	~SMeshBuffer();
+
+	void clear();
+
+	unsigned int numVertices() const;
+	unsigned int numFaces() const;
+	bool isModified() const;
+
+	// Topology follows the faces. Edges are numbered the way MFnMesh::create numbers them unless
+	// a topology with source numbering was set.
+	const SMeshTopology &topology();
+	void setTopology(const SMeshTopology &topology);
+	void invalidateTopology();
+
+	void computeFaceNormals(std::vector <SVec3> &faceNormals);
+	void computeVertexNormals(std::vector <SVec3> &normals) const;
+	void updateVertexNormals();
+	void addPolygonUVs();
+
+	// Editing kernels, they return false on invalid input and leave the buffer untouched
+	bool detachEdges(const std::vector <int> &edges, std::vector <unsigned int> &vtxMap, std::vector <unsigned int> &vtxSplitValence);
+	bool extrudeEdges(const std::vector <int> &edges, const float thickness, const unsigned int divisions);
+	bool pullVertices(const std::vector <int> &vertices, const float distance);
+	bool hardEdgeNormals(const std::vector <int> &edges, const double thresholdAngle, std::vector <int> &faceIds, std::vector <int> &vertexIds, std::vector <SVec3> &faceVertexNormals);
+	bool offsetEdgeloop(const std::vector <unsigned int> &loopEdges, const float offsetDistance, const bool createPolygons, SLoopOffset &offset);
+
+	// Batched loop offset. independentLoops returns the end of the run of loops from begin that
+	// share no vertices or vertex neighbours, offsetEdgeloops offsets such a run in one pass.
+	unsigned int independentLoops(const std::vector <std::vector<unsigned int>> &loops, const unsigned int begin);
+	bool offsetEdgeloops(const std::vector <std::vector<unsigned int>> &loops, const unsigned int begin, const unsigned int end, const float offsetDistance, const bool createPolygons, std::vector <SLoopOffset> &offsets);
+
+	std::vector <SVec3>
+		points,
+		normals,
+		vertexNormals;
+	std::vector <int>
+		counts,
+		indices;
+	std::vector <float>
+		u,
+		v;
+	std::vector <int>
+		uvCounts,
+		uvIndices;
+
+	bool
+		hasVertexNormals = false,
+		isTopologyModified = false,
+		arePointsModified = false,
+		areNormalsModified = false;
+
+protected:
+	SMeshTopology m_topology;
+	bool m_isTopologyDirty = true;
+
+	SVec3 polygonNormal(const int *polygon, const unsigned int count) const;
+};
\ No newline at end of file
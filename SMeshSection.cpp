@@ -0,0 +1,593 @@
+#include "SMeshSection.h"
+#include "SParallel.h"
+
+#include <algorithm>
+
+SMeshSection::SMeshSection() {
+	m_normal = SVec3(1, 0, 0);
+	clear();
+}
+
+SMeshSection::SMeshSection(const SVec3 &origin, const SVec3 &normal) {
+	setPlane(origin, normal);
+	clear();
+}
+
+SMeshSection::~SMeshSection() {}
+
+void SMeshSection::setPlane(const SVec3 &origin, const SVec3 &normal) {
+	m_origin = origin;
+	m_normal = normal;
+}
+
+SVec3 SMeshSection::origin() const {
+	return m_origin;
+}
+
+SVec3 SMeshSection::normal() const {
+	return m_normal;
+}
+
+void SMeshSection::clear() {
+	m_intersectionParameters.clear();
+	m_intersectionPoints.clear();
+	m_crossedEdges.clear();
+	m_crossedBoundaryEdges.clear();
+
+	m_contourOffsets.assign(1, 0);
+	m_contourPoints.clear();
+	m_contourEdges.clear();
+	m_contourParameters.clear();
+	m_isClosed.clear();
+	m_contourPlanes.clear();
+
+	m_isMarching = false;
+	m_segmentPartners.clear();
+}
+
+unsigned int SMeshSection::numContours() const {
+	return (unsigned int)m_isClosed.size();
+}
+
+unsigned int SMeshSection::contourOffset(const unsigned int contour) const {
+	return m_contourOffsets[contour];
+}
+
+unsigned int SMeshSection::contourCount(const unsigned int contour) const {
+	return m_contourOffsets[contour + 1] - m_contourOffsets[contour];
+}
+
+const SVec3 *SMeshSection::contourPoints(const unsigned int contour) const {
+	return m_contourPoints.data() + m_contourOffsets[contour];
+}
+
+const int *SMeshSection::contourEdges(const unsigned int contour) const {
+	return m_contourEdges.data() + m_contourOffsets[contour];
+}
+
+const double *SMeshSection::contourParameters(const unsigned int contour) const {
+	return m_contourParameters.data() + m_contourOffsets[contour];
+}
+
+bool SMeshSection::isClosed(const unsigned int contour) const {
+	return m_isClosed[contour];
+}
+
+unsigned int SMeshSection::contourPlane(const unsigned int contour) const {
+	return m_contourPlanes[contour];
+}
+
+void SMeshSection::getPolylines(std::vector <unsigned int> &offsets, std::vector <SVec3> &points, std::vector <bool> &closed, std::vector <int> &edges, std::vector <double> &parameters) const {
+	offsets.assign(m_contourOffsets.begin(), m_contourOffsets.end());
+	points.assign(m_contourPoints.begin(), m_contourPoints.end());
+	closed.assign(m_isClosed.begin(), m_isClosed.end());
+	edges.assign(m_contourEdges.begin(), m_contourEdges.end());
+	parameters.assign(m_contourParameters.begin(), m_contourParameters.end());
+}
+
+double SMeshSection::simplify(double tolerance) {
+	double maxDeviation = 0;
+
+	std::vector <char> keep;
+	std::vector <std::pair<unsigned int, unsigned int>> spans;
+	unsigned int write = 0;
+	for (unsigned int c = 0; c < numContours(); c++) {
+		unsigned int
+			begin = m_contourOffsets[c],
+			numPoints = m_contourOffsets[c + 1] - begin;
+		const SVec3 *points = m_contourPoints.data() + begin;
+
+		keep.assign(numPoints, 0);
+		keep[0] = keep[numPoints - 1] = 1;
+
+		spans.clear();
+		if (m_isClosed[c] && 2 < numPoints) {
+			unsigned int farthest = 1;
+			for (unsigned int i = 2; i < numPoints - 1; i++)
+				if ((points[farthest] - points[0]).squaredLength() < (points[i] - points[0]).squaredLength())
+					farthest = i;
+			keep[farthest] = 1;
+			spans.push_back(std::make_pair(0u, farthest));
+			spans.push_back(std::make_pair(farthest, numPoints - 1));
+		}
+		else
+			spans.push_back(std::make_pair(0u, numPoints - 1));
+
+		// Spans are split until every dropped point lies within tolerance of its chord
+		while (0 < spans.size()) {
+			unsigned int
+				first = spans.back().first,
+				last = spans.back().second,
+				farthest = first;
+			spans.pop_back();
+
+			double distance = 0;
+			for (unsigned int i = first + 1; i < last; i++) {
+				double pointDistance = points[i].distanceToSegment(points[first], points[last]);
+				if (distance < pointDistance) {
+					distance = pointDistance;
+					farthest = i;
+				}
+			}
+
+			if (tolerance < distance) {
+				keep[farthest] = 1;
+				spans.push_back(std::make_pair(first, farthest));
+				spans.push_back(std::make_pair(farthest, last));
+			}
+			else
+				maxDeviation = std::max(maxDeviation, distance);
+		}
+
+		// Compact in place, the write position never passes the read position
+		m_contourOffsets[c] = write;
+		for (unsigned int i = 0; i < numPoints; i++)
+			if (keep[i]) {
+				m_contourPoints[write] = m_contourPoints[begin + i];
+				m_contourEdges[write] = m_contourEdges[begin + i];
+				m_contourParameters[write] = m_contourParameters[begin + i];
+				write++;
+			}
+	}
+
+	m_contourOffsets.back() = write;
+	m_contourPoints.resize(write);
+	m_contourEdges.resize(write);
+	m_contourParameters.resize(write);
+
+	return maxDeviation;
+}
+
+// Same convention as SPlane::intersect, parameter has to lie within the segment
+bool SMeshSection::intersect(const SVec3 &point, const SVec3 &direction, SVec3 &intersection, double &parameter) const {
+	double dot = m_normal.dot(direction);
+	if (0 == dot)
+		return false;
+
+	double d = m_normal.dot(m_origin);
+	parameter = (d - m_normal.dot(point)) / dot;
+	intersection = point + direction*parameter;
+
+	if (parameter<0 || parameter>1)
+		return false;
+	return true;
+}
+
+bool SMeshSection::compute(const SMeshTopology &topology, const std::vector <SVec3> &points, double tolerance) {
+	clear();
+
+	if (topology.isNull() || points.size() != topology.numVertices())
+		return false;
+
+	//Find intersections
+	resetIntersections(topology);
+	findIntersections(topology, points);
+
+	buildContours(topology, tolerance, 0);
+
+	return true;
+}
+
+bool SMeshSection::compute(const SMeshTopology &topology, const std::vector <SVec3> &points, const SFaceBVH &tree, double tolerance) {
+	clear();
+
+	if (topology.isNull() || points.size() != topology.numVertices() || tree.numFaces() != topology.numFaces())
+		return false;
+
+	resetIntersections(topology);
+
+	// Every crossed edge lies on a face the plane touches, edges are tested in ascending order
+	tree.planeFaces(m_origin, m_normal, m_candidates);
+	std::vector <unsigned int> edges;
+	for (auto &face : m_candidates) {
+		const int *faceEdges = topology.faceEdges(face);
+		edges.insert(edges.end(), faceEdges, faceEdges + topology.faceCount(face));
+	}
+	std::sort(edges.begin(), edges.end());
+	edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+	// Only the vertices of candidate edges are measured, the others are never read
+	m_distances.resize(points.size());
+	double d = m_normal.dot(m_origin);
+	for (auto &edge : edges)
+		for (unsigned int i = 0; i < 2; i++) {
+			const SVec3 &point = points[topology.edgeVertex(edge, i)];
+			m_distances[topology.edgeVertex(edge, i)] = m_normal.x * point.x + m_normal.y * point.y + m_normal.z * point.z - d;
+		}
+
+	for (auto &edge : edges) {
+		double parameter;
+		if (!isCrossed(topology, edge, parameter))
+			continue;
+
+		const SVec3 &pointA = points[topology.edgeVertex(edge, 0)];
+		addIntersection(topology, edge, parameter, pointA + (points[topology.edgeVertex(edge, 1)] - pointA) * parameter);
+	}
+
+	buildContours(topology, tolerance, 0);
+
+	return true;
+}
+
+bool SMeshSection::computeMarching(const SMeshTopology &topology, const std::vector <SVec3> &points, double tolerance) {
+	clear();
+
+	if (topology.isNull() || points.size() != topology.numVertices())
+		return false;
+
+	resetIntersections(topology);
+	signedDistances(points, m_origin, m_normal, m_distances);
+
+	// Crossed edges are collected per chunk and joined in chunk order, so they stay ascending
+	unsigned int
+		numEdges = topology.numEdges(),
+		numChunks = SParallel::numChunks(numEdges, 1 << 16);
+	std::vector <std::vector <unsigned int>> chunkEdges(numChunks);
+	SParallel::forChunks(numEdges, numChunks, [&](unsigned int chunk, unsigned int begin, unsigned int end) {
+		double parameter;
+		for (unsigned int e = begin; e < end; e++)
+			if (isCrossed(topology, e, parameter))
+				chunkEdges[chunk].push_back(e);
+	});
+	for (auto &edges : chunkEdges)
+		m_crossedEdges.insert(m_crossedEdges.end(), edges.begin(), edges.end());
+
+	unsigned int numCrossed = (unsigned int)m_crossedEdges.size();
+	m_intersectionParameters.resize(numCrossed);
+	m_intersectionPoints.resize(numCrossed);
+	SParallel::forChunks(numCrossed, SParallel::numChunks(numCrossed, 1 << 14), [&](unsigned int, unsigned int begin, unsigned int end) {
+		for (unsigned int slot = begin; slot < end; slot++) {
+			unsigned int edge = m_crossedEdges[slot];
+			int vertices[2];
+			topology.getEdgeVertices(edge, vertices);
+
+			// Every collected edge is crossed, the call only recomputes its parameter
+			double parameter = 0;
+			isCrossed(topology, edge, parameter);
+			m_isCrossed[edge] = 1;
+			m_edgeSlots[edge] = slot;
+			m_intersectionParameters[slot] = parameter;
+			m_intersectionPoints[slot] = points[vertices[0]] + (points[vertices[1]] - points[vertices[0]]) * parameter;
+		}
+	});
+	for (auto &edge : m_crossedEdges)
+		if (topology.edgeOnBoundary(edge))
+			m_crossedBoundaryEdges.push_back(edge);
+
+	m_isMarching = linkSegments(topology);
+
+	buildContours(topology, tolerance, 0);
+
+	return true;
+}
+
+bool SMeshSection::computeSlices(const SMeshTopology &topology, const std::vector <SVec3> &points, const SVec3 &origin, const SVec3 &direction, const std::vector <double> &offsets, double tolerance) {
+	clear();
+
+	SVec3 normal = direction.normal();
+	if (topology.isNull() || points.size() != topology.numVertices() || normal == SVec3())
+		return false;
+
+	std::vector <double> &heights = m_distances;
+	signedDistances(points, origin, normal, heights);
+
+	// Offsets are searched in ascending order, planes keep their given index
+	std::vector <unsigned int> planeOrder(offsets.size());
+	for (unsigned int p = 0; p < planeOrder.size(); p++)
+		planeOrder[p] = p;
+	std::sort(planeOrder.begin(), planeOrder.end(), [&offsets](unsigned int a, unsigned int b) {
+		return offsets[a] < offsets[b];
+	});
+	std::vector <double> sortedOffsets(offsets.size());
+	for (unsigned int p = 0; p < planeOrder.size(); p++)
+		sortedOffsets[p] = offsets[planeOrder[p]];
+
+	// Edges are bucketed by the planes their height interval spans, counted first then filled
+	unsigned int numEdges = topology.numEdges();
+	auto planeRange = [&](unsigned int edge, unsigned int &first, unsigned int &last) {
+		double
+			heightA = heights[topology.edgeVertex(edge, 0)],
+			heightB = heights[topology.edgeVertex(edge, 1)];
+		first = last = 0;
+		if (heightA == heightB)
+			return;
+		first = (unsigned int)(std::lower_bound(sortedOffsets.begin(), sortedOffsets.end(), std::min(heightA, heightB)) - sortedOffsets.begin());
+		last = (unsigned int)(std::upper_bound(sortedOffsets.begin(), sortedOffsets.end(), std::max(heightA, heightB)) - sortedOffsets.begin());
+	};
+
+	std::vector <unsigned int> planeOffsets(offsets.size() + 1, 0);
+	for (unsigned int e = 0; e < numEdges; e++) {
+		unsigned int first, last;
+		planeRange(e, first, last);
+		for (unsigned int p = first; p < last; p++)
+			planeOffsets[planeOrder[p] + 1]++;
+	}
+	for (unsigned int p = 0; p < offsets.size(); p++)
+		planeOffsets[p + 1] += planeOffsets[p];
+
+	std::vector <unsigned int>
+		planeEdges(planeOffsets.back()),
+		planeFill(planeOffsets.begin(), planeOffsets.end() - 1);
+	for (unsigned int e = 0; e < numEdges; e++) {
+		unsigned int first, last;
+		planeRange(e, first, last);
+		for (unsigned int p = first; p < last; p++)
+			planeEdges[planeFill[planeOrder[p]]++] = e;
+	}
+
+	resetIntersections(topology);
+	for (unsigned int p = 0; p < offsets.size(); p++) {
+		for (unsigned int i = planeOffsets[p]; i < planeOffsets[p + 1]; i++) {
+			unsigned int edge = planeEdges[i];
+			unsigned int
+				vertexA = topology.edgeVertex(edge, 0),
+				vertexB = topology.edgeVertex(edge, 1);
+			double parameter = (offsets[p] - heights[vertexA]) / (heights[vertexB] - heights[vertexA]);
+			addIntersection(topology, edge, parameter, points[vertexA] + (points[vertexB] - points[vertexA]) * parameter);
+		}
+
+		buildContours(topology, tolerance, p);
+	}
+
+	return true;
+}
+
+// Chains the pending intersections into contours of the given plane. Every crossed edge is
+// consumed on the way, so the flags are all cleared again when this returns.
+void SMeshSection::buildContours(const SMeshTopology &topology, double tolerance, unsigned int plane) {
+	// Sort intersections and create contours
+	unsigned int
+		boundaryCursor = 0,
+		cursor = 0;
+	while (true) {
+		while (boundaryCursor < m_crossedBoundaryEdges.size() && !m_isCrossed[m_crossedBoundaryEdges[boundaryCursor]])
+			boundaryCursor++;
+		while (cursor < m_crossedEdges.size() && !m_isCrossed[m_crossedEdges[cursor]])
+			cursor++;
+		if (cursor == m_crossedEdges.size())
+			break;
+
+		unsigned int first = (boundaryCursor < m_crossedBoundaryEdges.size()) ? m_crossedBoundaryEdges[boundaryCursor] : m_crossedEdges[cursor];
+
+		bool isClosed = false;
+		sortIntersections(topology, first, m_sortedEdges, isClosed);
+
+		if (2 > m_sortedEdges.size())
+			continue;
+
+		// Contour is appended in place and dropped again when it turns out too short
+		unsigned int start = (unsigned int)m_contourPoints.size();
+		for (auto &edge : m_sortedEdges) {
+			unsigned int slot = m_edgeSlots[edge];
+			const SVec3 &point = m_intersectionPoints[slot];
+			if (start == m_contourPoints.size() || !m_contourPoints.back().isEquivalent(point, tolerance)) {
+				m_contourPoints.push_back(point);
+				m_contourEdges.push_back(edge);
+				m_contourParameters.push_back(m_intersectionParameters[slot]);
+			}
+		}
+		if (isClosed && m_contourPoints[start] != m_contourPoints.back()) {
+			SVec3 point = m_contourPoints[start];
+			int edge = m_contourEdges[start];
+			double parameter = m_contourParameters[start];
+			m_contourPoints.push_back(point);
+			m_contourEdges.push_back(edge);
+			m_contourParameters.push_back(parameter);
+		}
+
+		unsigned int numPoints = (unsigned int)m_contourPoints.size() - start;
+		if (2 > numPoints || (isClosed && 3 > numPoints)) {
+			m_contourPoints.resize(start);
+			m_contourEdges.resize(start);
+			m_contourParameters.resize(start);
+			continue;
+		}
+
+		m_contourOffsets.push_back((unsigned int)m_contourPoints.size());
+		m_isClosed.push_back(isClosed);
+		m_contourPlanes.push_back(plane);
+	}
+
+	m_intersectionParameters.clear();
+	m_intersectionPoints.clear();
+	m_crossedEdges.clear();
+	m_crossedBoundaryEdges.clear();
+}
+
+void SMeshSection::signedDistances(const std::vector <SVec3> &points, const SVec3 &origin, const SVec3 &normal, std::vector <double> &distances) {
+	unsigned int numPoints = (unsigned int)points.size();
+	distances.resize(numPoints);
+	if (numPoints == 0)
+		return;
+
+	// Plain strided loop over doubles, simple enough for the compiler to vectorise
+	const double *xyz = &points[0].x;
+	double *distance = distances.data();
+	const double
+		nx = normal.x,
+		ny = normal.y,
+		nz = normal.z,
+		d = normal.dot(origin);
+
+	SParallel::forChunks(numPoints, SParallel::numChunks(numPoints, 1 << 16), [&](unsigned int, unsigned int begin, unsigned int end) {
+		for (unsigned int v = begin; v < end; v++)
+			distance[v] = nx * xyz[3 * v] + ny * xyz[3 * v + 1] + nz * xyz[3 * v + 2] - d;
+	});
+}
+
+// Every vertex is measured once, edges are crossed where the distance changes sign
+void SMeshSection::findIntersections(const SMeshTopology &topology, const std::vector <SVec3> &points) {
+	signedDistances(points, m_origin, m_normal, m_distances);
+
+	for (unsigned int e = 0; e < topology.numEdges(); e++) {
+		double parameter;
+		if (!isCrossed(topology, e, parameter))
+			continue;
+
+		const SVec3 &pointA = points[topology.edgeVertex(e, 0)];
+		addIntersection(topology, e, parameter, pointA + (points[topology.edgeVertex(e, 1)] - pointA) * parameter);
+	}
+}
+
+// Classifies an edge by the signed distances of its vertices. The parameter is exactly 0 or 1
+// on a vertex, sortIntersections relies on that.
+bool SMeshSection::isCrossed(const SMeshTopology &topology, unsigned int edge, double &parameter) const {
+	double
+		distanceA = m_distances[topology.edgeVertex(edge, 0)],
+		distanceB = m_distances[topology.edgeVertex(edge, 1)];
+	if (distanceA == distanceB || (0 < distanceA && 0 < distanceB) || (distanceA < 0 && distanceB < 0))
+		return false;
+
+	parameter = distanceA / (distanceA - distanceB);
+	return true;
+}
+
+// Every crossed face joins its two crossed edges. A crossed edge stores the partner from each
+// of its faces in the order of topology.edgeFaces, which is the order the edge walk visits
+// them in. Returns false when a face does not reduce to a single segment.
+bool SMeshSection::linkSegments(const SMeshTopology &topology) {
+	m_segmentPartners.assign(2 * m_crossedEdges.size(), -1);
+
+	unsigned int
+		numFaces = topology.numFaces(),
+		numChunks = SParallel::numChunks(numFaces, 1 << 16);
+	std::vector <char> isRegular(numChunks, 1);
+	SParallel::forChunks(numFaces, numChunks, [&](unsigned int chunk, unsigned int begin, unsigned int end) {
+		for (unsigned int f = begin; f < end && isRegular[chunk]; f++) {
+			const int *faceEdges = topology.faceEdges(f);
+			int crossedEdges[2];
+			unsigned int numCrossed = 0;
+			for (unsigned int i = 0; i < topology.faceCount(f); i++) {
+				int edge = faceEdges[i];
+				if (!m_isCrossed[edge])
+					continue;
+
+				double parameter = m_intersectionParameters[m_edgeSlots[edge]];
+				if (2 == numCrossed || 0 == parameter || 1 == parameter || 2 < topology.numEdgeFaces(edge)) {
+					isRegular[chunk] = 0;
+					break;
+				}
+				crossedEdges[numCrossed++] = edge;
+			}
+
+			if (1 == numCrossed)
+				isRegular[chunk] = 0;
+			if (2 != numCrossed || !isRegular[chunk])
+				continue;
+
+			// Each (edge, face) pair is written by this face only
+			for (unsigned int i = 0; i < 2; i++) {
+				int edge = crossedEdges[i];
+				unsigned int side = ((int)f == topology.edgeFaces(edge)[0]) ? 0 : 1;
+				m_segmentPartners[2 * m_edgeSlots[edge] + side] = crossedEdges[1 - i];
+			}
+		}
+	});
+
+	return std::find(isRegular.begin(), isRegular.end(), 0) == isRegular.end();
+}
+
+// Per edge arrays are kept between computes, the flags are already cleared by buildContours
+void SMeshSection::resetIntersections(const SMeshTopology &topology) {
+	if (m_isCrossed.size() != topology.numEdges()) {
+		m_isCrossed.assign(topology.numEdges(), 0);
+		m_edgeSlots.resize(topology.numEdges());
+	}
+	m_intersectionParameters.clear();
+	m_intersectionPoints.clear();
+	m_crossedEdges.clear();
+	m_crossedBoundaryEdges.clear();
+}
+
+// Edges have to be added in ascending order
+void SMeshSection::addIntersection(const SMeshTopology &topology, unsigned int edge, double parameter, const SVec3 &point) {
+	m_isCrossed[edge] = 1;
+	m_edgeSlots[edge] = (unsigned int)m_crossedEdges.size();
+	m_intersectionParameters.push_back(parameter);
+	m_intersectionPoints.push_back(point);
+
+	m_crossedEdges.push_back(edge);
+	if (topology.edgeOnBoundary(edge))
+		m_crossedBoundaryEdges.push_back(edge);
+}
+
+// Walks from face to face until no crossed edge is left next to the current one
+void SMeshSection::sortIntersections(const SMeshTopology &topology, unsigned int firstEdge, std::vector <int> &sortedEdges, bool &isClosed) {
+	sortedEdges.clear();
+
+	int currentEdge = firstEdge;
+	while (true) {
+		sortedEdges.push_back(currentEdge);
+		m_isCrossed[currentEdge] = 0;
+
+		int nextEdge = (m_isMarching) ? nextSegment(currentEdge) : nextIntersection(topology, currentEdge);
+		if (nextEdge < 0)
+			break;
+		currentEdge = nextEdge;
+	}
+
+	isClosed = (topology.edgeOnBoundary(currentEdge)) ? false : true;
+}
+
+// First crossed edge of the faces around the intersection, -1 if there is none
+int SMeshSection::nextIntersection(const SMeshTopology &topology, unsigned int edge) {
+	// If inersection on vertex, get rid of faces sharing this vertex
+	const int *connectedFaces;
+	unsigned int numConnectedFaces;
+	double parameter = m_intersectionParameters[m_edgeSlots[edge]];
+	if (1==parameter || 0==parameter) {
+		unsigned int vertex = topology.edgeVertex(edge, int(parameter));
+		connectedFaces = topology.connectedFaces(vertex);
+		numConnectedFaces = topology.numConnectedFaces(vertex);
+		clearConnected(topology, vertex);
+	}
+	else {
+		connectedFaces = topology.edgeFaces(edge);
+		numConnectedFaces = topology.numEdgeFaces(edge);
+	}
+
+	// Iterate over connected faces, looking for next intersection
+	for (unsigned int f = 0; f<numConnectedFaces; f++) {
+		const int *connectedEdges = topology.faceEdges(connectedFaces[f]);
+		for (unsigned int e = 0; e < topology.faceCount(connectedFaces[f]); e++)
+			if (m_isCrossed[connectedEdges[e]])
+				return connectedEdges[e];
+	}
+
+	return -1;
+}
+
+int SMeshSection::nextSegment(unsigned int edge) const {
+	const int *partners = m_segmentPartners.data() + 2 * m_edgeSlots[edge];
+	for (unsigned int side = 0; side < 2; side++)
+		if (0 <= partners[side] && m_isCrossed[partners[side]])
+			return partners[side];
+
+	return -1;
+}
+
+void SMeshSection::clearConnected(const SMeshTopology &topology, unsigned int vertex) {
+	const int *connectedEdges = topology.connectedEdges(vertex);
+	for (unsigned int e = 0; e < topology.numConnectedEdges(vertex); e++)
+		m_isCrossed[connectedEdges[e]] = 0;
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "SVec3.h"
+#include "SMeshTopology.h"
+#include "SFaceBVH.h"
+
+#include <vector>
+
+// Maya independent plane/mesh section. Crossed edges are chained into contours through the
+// faces they share, contours start on the boundary where possible.
+class SMeshSection
+{
+public:
+	SMeshSection();
+	SMeshSection(const SVec3 &origin, const SVec3 &normal);
+	~SMeshSection();
+
+	void setPlane(const SVec3 &origin, const SVec3 &normal);
+	SVec3 origin() const;
+	SVec3 normal() const;
+
+	// Points are expected in the space of the plane. Consecutive contour points closer than
+	// tolerance are merged.
+	bool compute(const SMeshTopology &topology, const std::vector <SVec3> &points, double tolerance = 0.01);
+
+	// Same contours as compute, only the edges of faces whose bounds the plane touches are tested.
+	// The tree has to be built from the same topology and points.
+	bool compute(const SMeshTopology &topology, const std::vector <SVec3> &points, const SFaceBVH &tree, double tolerance = 0.01);
+
+	// Same contours as compute, found by marching faces. Crossings and the segment every crossed
+	// face contributes are found in parallel, only the walk along the segments is serial. Planes
+	// through vertices, faces crossed more than twice and non-manifold crossed edges fall back
+	// to the edge walk of compute.
+	bool computeMarching(const SMeshTopology &topology, const std::vector <SVec3> &points, double tolerance = 0.01);
+
+	// Stack of parallel planes at origin + direction * offset, with direction normalised. Vertex
+	// heights along the direction are computed once and every edge is only handed to the planes
+	// its height interval spans. Contours come out plane by plane in the order of offsets.
+	bool computeSlices(const SMeshTopology &topology, const std::vector <SVec3> &points, const SVec3 &origin, const SVec3 &direction, const std::vector <double> &offsets, double tolerance = 0.01);
+	void clear();
+
+	// Contours are stored flat, contour c owns the entries contourOffset(c) .. contourOffset(c + 1)
+	// of the point, edge and parameter arrays. Parameters are the positions along the edges.
+	unsigned int numContours() const;
+	unsigned int contourPlane(const unsigned int contour) const;
+	unsigned int contourOffset(const unsigned int contour) const;
+	unsigned int contourCount(const unsigned int contour) const;
+	const SVec3 *contourPoints(const unsigned int contour) const;
+	const int *contourEdges(const unsigned int contour) const;
+	const double *contourParameters(const unsigned int contour) const;
+	bool isClosed(const unsigned int contour) const;
+
+	// Copies all contours into caller owned buffers, offsets get numContours + 1 entries. The
+	// buffers keep their capacity, so reusing them between calls does not allocate.
+	void getPolylines(std::vector <unsigned int> &offsets, std::vector <SVec3> &points, std::vector <bool> &closed, std::vector <int> &edges, std::vector <double> &parameters) const;
+
+	// Douglas-Peucker on every contour in place, points closer than tolerance to the polyline
+	// that replaces them are dropped. Closed contours always keep the point farthest from their
+	// start. Returns the largest distance of a dropped point from the simplified contour.
+	double simplify(double tolerance);
+
+	bool intersect(const SVec3 &point, const SVec3 &direction, SVec3 &intersection, double &parameter) const;
+
+	// normal . (point - origin) for every point, in one flat pass over the xyz buffer
+	static void signedDistances(const std::vector <SVec3> &points, const SVec3 &origin, const SVec3 &normal, std::vector <double> &distances);
+
+protected:
+	SVec3 m_origin;
+	SVec3 m_normal;
+
+	// Pending intersections. Flags and slots are indexed by edge id, the flags are all cleared
+	// again once the contours are built. Crossed edges are listed in ascending order, boundary
+	// ones separately, so start edges are found with forward cursors.
+	std::vector <char> m_isCrossed;
+	std::vector <unsigned int>
+		m_edgeSlots,
+		m_crossedEdges,
+		m_crossedBoundaryEdges;
+	std::vector <double> m_intersectionParameters;
+	std::vector <SVec3> m_intersectionPoints;
+
+	// Face marching, two partner edges per crossed edge, one for each of its faces
+	bool m_isMarching = false;
+	std::vector <int> m_segmentPartners;
+
+	std::vector <unsigned int> m_contourOffsets;
+	std::vector <SVec3> m_contourPoints;
+	std::vector <int>
+		m_contourEdges,
+		m_sortedEdges;
+	std::vector <double> m_contourParameters;
+	std::vector <bool> m_isClosed;
+	std::vector <unsigned int> m_contourPlanes;
+	std::vector <double> m_distances;
+	std::vector <unsigned int> m_candidates;
+
+	void resetIntersections(const SMeshTopology &topology);
+	void findIntersections(const SMeshTopology &topology, const std::vector <SVec3> &points);
+	bool isCrossed(const SMeshTopology &topology, unsigned int edge, double &parameter) const;
+	bool linkSegments(const SMeshTopology &topology);
+	void addIntersection(const SMeshTopology &topology, unsigned int edge, double parameter, const SVec3 &point);
+	void buildContours(const SMeshTopology &topology, double tolerance, unsigned int plane);
+	void sortIntersections(const SMeshTopology &topology, unsigned int firstEdge, std::vector <int> &sortedEdges, bool &isClosed);
+	int nextIntersection(const SMeshTopology &topology, unsigned int edge);
+	int nextSegment(unsigned int edge) const;
+	void clearConnected(const SMeshTopology &topology, unsigned int vertex);
+};
\ No newline at end of file
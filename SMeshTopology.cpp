@@ -0,0 +1,659 @@
+#include "SMeshTopology.h"
+#include "SUnionFind.h"
+#include "SParallel.h"
+
+#include <algorithm>
+#include <utility>
+#include <deque>
+
+SMeshTopology::SMeshTopology() {}
+
+SMeshTopology::~SMeshTopology() {}
+
+bool SMeshTopology::build(unsigned int numVertices, const std::vector<int> &counts, const std::vector<int> &indices, const std::vector<int> &edgeVertices) {
+	clear();
+
+	// Face offsets
+	m_faceOffsets.resize(counts.size() + 1);
+	m_faceOffsets[0] = 0;
+	for (unsigned int f = 0; f < counts.size(); f++) {
+		if (counts[f] < 0) {
+			clear();
+			return false;
+		}
+		m_faceOffsets[f + 1] = m_faceOffsets[f] + counts[f];
+	}
+	if ((unsigned int)m_faceOffsets.back() != indices.size()) {
+		clear();
+		return false;
+	}
+
+	for (auto &vertex : indices)
+		if (vertex < 0 || numVertices <= (unsigned int)vertex) {
+			clear();
+			return false;
+		}
+
+	m_numVertices = numVertices;
+	m_faceVertices = indices;
+
+	// Edges either come from the source mesh or are generated from faces
+	bool result;
+	if (edgeVertices.size() == 0)
+		result = generateEdges();
+	else {
+		m_edgeVertices = edgeVertices;
+		result = assignFaceEdges();
+	}
+	if (!result) {
+		clear();
+		return false;
+	}
+
+	buildEdgeFaces();
+	buildVertexStars();
+
+	m_hash = hash(m_numVertices, numEdges(), counts.data(), (unsigned int)counts.size(), indices.data(), (unsigned int)indices.size());
+
+	return true;
+}
+
+void SMeshTopology::clear() {
+	m_numVertices = 0;
+	m_hash = 0;
+	m_faceOffsets.clear();
+	m_faceVertices.clear();
+	m_faceEdges.clear();
+	m_edgeVertices.clear();
+	m_edgeFaceOffsets.clear();
+	m_edgeFaces.clear();
+	m_vertexEdgeOffsets.clear();
+	m_vertexEdges.clear();
+	m_vertexFaceOffsets.clear();
+	m_vertexFaces.clear();
+	m_onBoundary.clear();
+}
+
+bool SMeshTopology::isNull() const {
+	return m_vertexEdgeOffsets.size() == 0;
+}
+
+unsigned int SMeshTopology::numVertices() const {
+	return m_numVertices;
+}
+
+unsigned int SMeshTopology::numEdges() const {
+	return (unsigned int)m_edgeVertices.size() / 2;
+}
+
+unsigned int SMeshTopology::numFaces() const {
+	return (m_faceOffsets.size() == 0) ? 0 : (unsigned int)m_faceOffsets.size() - 1;
+}
+
+unsigned int SMeshTopology::numFaceVertices() const {
+	return (unsigned int)m_faceVertices.size();
+}
+
+unsigned long long SMeshTopology::hash() const {
+	return m_hash;
+}
+
+// FNV-1a over 32 bit words
+unsigned long long SMeshTopology::hash(unsigned int numVertices, unsigned int numEdges, const int *counts, unsigned int numFaces, const int *indices, unsigned int numIndices) {
+	const unsigned long long prime = 0x100000001B3ULL;
+	unsigned long long value = 0xCBF29CE484222325ULL;
+
+	value = (value ^ numVertices) * prime;
+	value = (value ^ numEdges) * prime;
+	value = (value ^ numFaces) * prime;
+	for (unsigned int i = 0; i < numFaces; i++)
+		value = (value ^ (unsigned int)counts[i]) * prime;
+	value = (value ^ numIndices) * prime;
+	for (unsigned int i = 0; i < numIndices; i++)
+		value = (value ^ (unsigned int)indices[i]) * prime;
+
+	return value;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Queries ////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int SMeshTopology::numConnectedEdges(const unsigned int vertex) const {
+	return m_vertexEdgeOffsets[vertex + 1] - m_vertexEdgeOffsets[vertex];
+}
+
+const int *SMeshTopology::connectedEdges(const unsigned int vertex) const {
+	return m_vertexEdges.data() + m_vertexEdgeOffsets[vertex];
+}
+
+unsigned int SMeshTopology::numConnectedFaces(const unsigned int vertex) const {
+	return m_vertexFaceOffsets[vertex + 1] - m_vertexFaceOffsets[vertex];
+}
+
+const int *SMeshTopology::connectedFaces(const unsigned int vertex) const {
+	return m_vertexFaces.data() + m_vertexFaceOffsets[vertex];
+}
+
+bool SMeshTopology::onBoundary(const unsigned int vertex) const {
+	return m_onBoundary[vertex];
+}
+
+int SMeshTopology::oppositeVertex(const unsigned int vertex, const unsigned int edge) const {
+	return (m_edgeVertices[2 * edge] == (int)vertex) ? m_edgeVertices[2 * edge + 1] : m_edgeVertices[2 * edge];
+}
+
+int SMeshTopology::relativeEdgeIndex(const unsigned int vertex, const unsigned int edge) const {
+	const int *edges = connectedEdges(vertex);
+	unsigned int numEdges = numConnectedEdges(vertex);
+	for (unsigned int e = 0; e < numEdges; e++)
+		if (edges[e] == (int)edge)
+			return e;
+	return -1;
+}
+
+void SMeshTopology::getEdgeVertices(const unsigned int edge, int vertices[2]) const {
+	vertices[0] = m_edgeVertices[2 * edge];
+	vertices[1] = m_edgeVertices[2 * edge + 1];
+}
+
+int SMeshTopology::edgeVertex(const unsigned int edge, const unsigned int end) const {
+	return m_edgeVertices[2 * edge + end];
+}
+
+unsigned int SMeshTopology::numEdgeFaces(const unsigned int edge) const {
+	return m_edgeFaceOffsets[edge + 1] - m_edgeFaceOffsets[edge];
+}
+
+const int *SMeshTopology::edgeFaces(const unsigned int edge) const {
+	return m_edgeFaces.data() + m_edgeFaceOffsets[edge];
+}
+
+bool SMeshTopology::edgeOnBoundary(const unsigned int edge) const {
+	return numEdgeFaces(edge) < 2;
+}
+
+int SMeshTopology::findEdge(const unsigned int vertexA, const unsigned int vertexB) const {
+	const int *edges = connectedEdges(vertexA);
+	unsigned int numEdges = numConnectedEdges(vertexA);
+	for (unsigned int e = 0; e < numEdges; e++)
+		if (oppositeVertex(vertexA, edges[e]) == (int)vertexB)
+			return edges[e];
+	return -1;
+}
+
+unsigned int SMeshTopology::faceOffset(const unsigned int face) const {
+	return m_faceOffsets[face];
+}
+
+unsigned int SMeshTopology::faceCount(const unsigned int face) const {
+	return m_faceOffsets[face + 1] - m_faceOffsets[face];
+}
+
+const int *SMeshTopology::faceVertices(const unsigned int face) const {
+	return m_faceVertices.data() + m_faceOffsets[face];
+}
+
+const int *SMeshTopology::faceEdges(const unsigned int face) const {
+	return m_faceEdges.data() + m_faceOffsets[face];
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Component grouping  ////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Selections below this size are grouped on the calling thread
+static const unsigned int kParallelGroupingSize = 1 << 20;
+
+bool SMeshTopology::groupConnectedFaces(const std::vector<int> &faces, std::vector<int> &groupOffsets, std::vector<int> &groupElements, bool parallel) const {
+	// Faces are connected through shared edges
+	auto neighbors = [this](unsigned int face, std::vector<int> &connected) {
+		const int *edges = faceEdges(face);
+		for (unsigned int e = 0; e < faceCount(face); e++)
+			for (unsigned int f = 0; f < numEdgeFaces(edges[e]); f++)
+				connected.push_back(edgeFaces(edges[e])[f]);
+	};
+
+	return groupConnected(numFaces(), faces, neighbors, groupOffsets, groupElements, parallel);
+}
+
+bool SMeshTopology::groupConnectedVertices(const std::vector<int> &vertices, std::vector<int> &groupOffsets, std::vector<int> &groupElements, bool parallel) const {
+	// Vertices are connected through edges
+	auto neighbors = [this](unsigned int vertex, std::vector<int> &connected) {
+		const int *edges = connectedEdges(vertex);
+		for (unsigned int e = 0; e < numConnectedEdges(vertex); e++)
+			connected.push_back(oppositeVertex(vertex, edges[e]));
+	};
+
+	return groupConnected(numVertices(), vertices, neighbors, groupOffsets, groupElements, parallel);
+}
+
+template <typename Neighbors>
+bool SMeshTopology::groupConnected(unsigned int numElements, const std::vector<int> &elements, Neighbors neighbors, std::vector<int> &groupOffsets, std::vector<int> &groupElements, bool parallel) {
+	groupOffsets.assign(1, 0);
+	groupElements.clear();
+
+	std::vector <bool> selected(numElements, false);
+	for (auto &element : elements) {
+		if (element < 0 || numElements <= (unsigned int)element)
+			return false;
+		selected[element] = true;
+	}
+
+	// Every chunk unites pairs inside its own range, pairs crossing chunks are united afterwards
+	SUnionFind sets(numElements);
+	unsigned int chunks = (parallel && kParallelGroupingSize <= elements.size()) ? SParallel::numChunks(numElements, 1 << 16) : 1;
+	std::vector <std::vector <std::pair<unsigned int, unsigned int>>> crossing(chunks);
+
+	SParallel::forChunks(numElements, chunks, [&](unsigned int chunk, unsigned int begin, unsigned int end) {
+		std::vector <int> connected;
+		for (unsigned int element = begin; element < end; element++) {
+			if (!selected[element])
+				continue;
+
+			connected.clear();
+			neighbors(element, connected);
+			for (auto &neighbor : connected) {
+				unsigned int other = neighbor;
+				if (!selected[other])
+					continue;
+				if (begin <= other && other < end)
+					sets.unite(element, other);
+				else if (element < other)
+					crossing[chunk].push_back(std::make_pair(element, other));
+			}
+		}
+	});
+
+	for (auto &pairs : crossing)
+		for (auto &pair : pairs)
+			sets.unite(pair.first, pair.second);
+
+	// Groups are ordered by their smallest element, elements ascend within a group
+	std::vector <int> groupIds(numElements, -1), groupSizes;
+	for (unsigned int element = 0; element < numElements; element++) {
+		if (!selected[element])
+			continue;
+		unsigned int root = sets.find(element);
+		if (root == element) {
+			groupIds[root] = (int)groupSizes.size();
+			groupSizes.push_back(0);
+		}
+		groupIds[element] = groupIds[root];
+		groupSizes[groupIds[element]]++;
+	}
+
+	groupOffsets.resize(groupSizes.size() + 1);
+	for (unsigned int g = 0; g < groupSizes.size(); g++)
+		groupOffsets[g + 1] = groupOffsets[g] + groupSizes[g];
+
+	groupElements.resize(groupOffsets.back());
+	std::vector <int> fill(groupOffsets.begin(), groupOffsets.end() - 1);
+	for (unsigned int element = 0; element < numElements; element++)
+		if (selected[element])
+			groupElements[fill[groupIds[element]]++] = element;
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Edge loops /////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool SMeshTopology::findEdgeLoops(const std::vector<int> &edges, std::vector<int> &loopOffsets, std::vector<int> &loopEdges, std::vector<bool> &loopFlipped) const {
+	loopOffsets.assign(1, 0);
+	loopEdges.clear();
+	loopFlipped.clear();
+
+	// Check if mesh contains listed edges
+	std::vector <bool> remainingEdges(numEdges(), false);
+	std::vector <unsigned int> startVertices;
+	for (auto &edge : edges) {
+		if (edge < 0 || numEdges() <= (unsigned int)edge)
+			return false;
+		remainingEdges[edge] = true;
+		startVertices.push_back(edgeVertex(edge, 0));
+		startVertices.push_back(edgeVertex(edge, 1));
+	}
+
+	// Only vertices touching listed edges can start a loop, visit them in index order
+	std::sort(startVertices.begin(), startVertices.end());
+	startVertices.erase(std::unique(startVertices.begin(), startVertices.end()), startVertices.end());
+
+	std::deque <int> ordered;
+	std::deque <bool> flipped;
+
+	// Adds edges oriented to the loop end they touch, then walks on until the loop ends
+	auto contiguousEdges = [&](unsigned int vertex, int edge) -> bool {
+		while (0 <= edge) {
+			if (ordered.size() == 0) {
+				ordered.push_back(edge);
+				flipped.push_back(false);
+			}
+			else {
+				int verticesNew[2], verticesFirst[2], verticesLast[2];
+				getEdgeVertices(edge, verticesNew);
+				getEdgeVertices(ordered.front(), verticesFirst);
+				if (flipped.front())
+					std::swap(verticesFirst[0], verticesFirst[1]);
+				getEdgeVertices(ordered.back(), verticesLast);
+				if (flipped.back())
+					std::swap(verticesLast[0], verticesLast[1]);
+
+				bool
+					toFront = false,
+					flip = false;
+				if (verticesFirst[0] == verticesNew[1])
+					toFront = true;
+				else if (verticesFirst[0] == verticesNew[0])
+					toFront = flip = true;
+				else if (verticesLast[1] != verticesNew[0] && verticesLast[1] == verticesNew[1])
+					flip = true;
+
+				if (toFront) {
+					ordered.push_front(edge);
+					flipped.push_front(flip);
+				}
+				else {
+					ordered.push_back(edge);
+					flipped.push_back(flip);
+				}
+			}
+			remainingEdges[edge] = false;
+
+			vertex = oppositeVertex(vertex, edge);
+
+			bool isValid;
+			edge = nextLoopEdge(vertex, remainingEdges, ordered.front(), ordered.back(), isValid);
+			if (!isValid)
+				return false;
+		}
+		return true;
+	};
+
+	for (auto &vertex : startVertices) {
+		const int *conEdges = connectedEdges(vertex);
+		unsigned int numConEdges = numConnectedEdges(vertex);
+		bool isOnBoundary = onBoundary(vertex);
+
+		for (unsigned int e = 0; e < numConEdges; e++) {
+			int edgeId = conEdges[e];
+			if (!remainingEdges[edgeId])
+				continue;
+
+			ordered.clear();
+			flipped.clear();
+			if (!contiguousEdges(vertex, edgeId))
+				return false;
+
+			// Explore edge in opposite direction
+			if ((!isOnBoundary && numConEdges == 4 && e < 2) || (isOnBoundary && 2 < numConEdges && e == 0)) {
+				int relOutIdx = (isOnBoundary) ? numConEdges - 1 : e + 2;
+				int outIdx = conEdges[relOutIdx];
+				if (remainingEdges[outIdx] && !contiguousEdges(vertex, outIdx))
+					return false;
+			}
+
+			loopEdges.insert(loopEdges.end(), ordered.begin(), ordered.end());
+			loopFlipped.insert(loopFlipped.end(), flipped.begin(), flipped.end());
+			loopOffsets.push_back((int)loopEdges.size());
+		}
+	}
+
+	return true;
+}
+
+// Edge continuing a loop straight through vertex, -1 when the loop ends there
+int SMeshTopology::nextLoopEdge(const unsigned int vertex, const std::vector<bool> &remainingEdges, const int firstEdge, const int lastEdge, bool &isValid) const {
+	isValid = true;
+
+	const int *conEdges = connectedEdges(vertex);
+	int numConEdges = numConnectedEdges(vertex);
+	bool isOnBoundary = onBoundary(vertex);
+
+	// End loop once you hit star-shaped vertex
+	if ((isOnBoundary && numConEdges == 2) ||
+		(!isOnBoundary && numConEdges != 4))
+		return -1;
+
+	// Find vertex relative index of incoming edge
+	int relInIdx = -1;
+	for (int e = 0; e < numConEdges; e++)
+		if (conEdges[e] == firstEdge || conEdges[e] == lastEdge) {
+			relInIdx = e;
+			break;
+		}
+	if (relInIdx < 0) {
+		isValid = false;
+		return -1;
+	}
+
+	// End loop once boundary is reached
+	if (isOnBoundary && (relInIdx != 0 && relInIdx != numConEdges - 1))
+		return -1;
+
+	// Find index of outcoming edge
+	int relOutIdx;
+	if (isOnBoundary)
+		relOutIdx = (relInIdx == 0) ? numConEdges - 1 : 0;
+	else
+		relOutIdx = (relInIdx + 2) % numConEdges;
+	int outIdx = conEdges[relOutIdx];
+
+	return (remainingEdges[outIdx]) ? outIdx : -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Protected methods //////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool SMeshTopology::generateEdges() {
+	unsigned int numSides = (unsigned int)m_faceVertices.size();
+
+	// Sort face sides by their vertex pair, ties keep face order
+	std::vector <std::pair<unsigned long long, unsigned int>> sides(numSides);
+	for (unsigned int f = 0; f < numFaces(); f++) {
+		unsigned int offset = m_faceOffsets[f], count = faceCount(f);
+		for (unsigned int k = 0; k < count; k++) {
+			unsigned long long
+				a = (unsigned int)m_faceVertices[offset + k],
+				b = (unsigned int)m_faceVertices[offset + (k + 1) % count];
+			sides[offset + k].first = (a < b) ? (a << 32 | b) : (b << 32 | a);
+			sides[offset + k].second = offset + k;
+		}
+	}
+	std::sort(sides.begin(), sides.end());
+
+	std::vector <unsigned int> firstSide(numSides);
+	for (unsigned int s = 0; s < numSides; s++)
+		firstSide[sides[s].second] = (s == 0 || sides[s].first != sides[s - 1].first) ? sides[s].second : firstSide[sides[s - 1].second];
+
+	// Number edges by their first use
+	m_faceEdges.resize(numSides);
+	for (unsigned int f = 0; f < numFaces(); f++) {
+		unsigned int offset = m_faceOffsets[f], count = faceCount(f);
+		for (unsigned int k = 0; k < count; k++) {
+			unsigned int side = offset + k;
+			if (firstSide[side] != side) {
+				m_faceEdges[side] = m_faceEdges[firstSide[side]];
+				continue;
+			}
+			m_faceEdges[side] = (int)m_edgeVertices.size() / 2;
+			m_edgeVertices.push_back(m_faceVertices[side]);
+			m_edgeVertices.push_back(m_faceVertices[offset + (k + 1) % count]);
+		}
+	}
+
+	return true;
+}
+
+bool SMeshTopology::assignFaceEdges() {
+	if (m_edgeVertices.size() % 2 != 0)
+		return false;
+
+	for (auto &vertex : m_edgeVertices)
+		if (vertex < 0 || m_numVertices <= (unsigned int)vertex)
+			return false;
+
+	// Unordered vertex -> edge lookup
+	std::vector <int> offsets(m_numVertices + 1, 0), star(m_edgeVertices.size());
+	for (auto &vertex : m_edgeVertices)
+		offsets[vertex + 1]++;
+	for (unsigned int v = 0; v < m_numVertices; v++)
+		offsets[v + 1] += offsets[v];
+	std::vector <int> fill(offsets.begin(), offsets.end() - 1);
+	for (unsigned int i = 0; i < m_edgeVertices.size(); i++)
+		star[fill[m_edgeVertices[i]]++] = i / 2;
+
+	m_faceEdges.resize(m_faceVertices.size());
+	for (unsigned int f = 0; f < numFaces(); f++) {
+		unsigned int offset = m_faceOffsets[f], count = faceCount(f);
+		for (unsigned int k = 0; k < count; k++) {
+			int
+				a = m_faceVertices[offset + k],
+				b = m_faceVertices[offset + (k + 1) % count],
+				edge = -1;
+
+			for (int i = offsets[a]; i < offsets[a + 1]; i++) {
+				int e = star[i];
+				if (m_edgeVertices[2 * e] + m_edgeVertices[2 * e + 1] - a == b) {
+					edge = e;
+					break;
+				}
+			}
+			if (edge < 0)
+				return false;
+
+			m_faceEdges[offset + k] = edge;
+		}
+	}
+
+	return true;
+}
+
+void SMeshTopology::buildEdgeFaces() {
+	m_edgeFaceOffsets.assign(numEdges() + 1, 0);
+	for (auto &edge : m_faceEdges)
+		m_edgeFaceOffsets[edge + 1]++;
+	for (unsigned int e = 0; e < numEdges(); e++)
+		m_edgeFaceOffsets[e + 1] += m_edgeFaceOffsets[e];
+
+	m_edgeFaces.resize(m_faceEdges.size());
+	std::vector <int> fill(m_edgeFaceOffsets.begin(), m_edgeFaceOffsets.end() - 1);
+	for (unsigned int f = 0; f < numFaces(); f++)
+		for (int i = m_faceOffsets[f]; i < m_faceOffsets[f + 1]; i++)
+			m_edgeFaces[fill[m_faceEdges[i]]++] = f;
+}
+
+void SMeshTopology::buildVertexStars() {
+	unsigned int numSides = (unsigned int)m_faceVertices.size();
+
+	// Face corners per vertex
+	std::vector <int> cornerOffsets(m_numVertices + 1, 0), corners(numSides), sideFace(numSides);
+	for (auto &vertex : m_faceVertices)
+		cornerOffsets[vertex + 1]++;
+	for (unsigned int v = 0; v < m_numVertices; v++)
+		cornerOffsets[v + 1] += cornerOffsets[v];
+	std::vector <int> fill(cornerOffsets.begin(), cornerOffsets.end() - 1);
+	for (unsigned int f = 0; f < numFaces(); f++)
+		for (int i = m_faceOffsets[f]; i < m_faceOffsets[f + 1]; i++) {
+			corners[fill[m_faceVertices[i]]++] = i;
+			sideFace[i] = f;
+		}
+
+	// Edges per vertex, catches edges without faces
+	std::vector <int> edgeOffsets(m_numVertices + 1, 0), edgeStar(m_edgeVertices.size());
+	for (auto &vertex : m_edgeVertices)
+		edgeOffsets[vertex + 1]++;
+	for (unsigned int v = 0; v < m_numVertices; v++)
+		edgeOffsets[v + 1] += edgeOffsets[v];
+	fill.assign(edgeOffsets.begin(), edgeOffsets.end() - 1);
+	for (unsigned int i = 0; i < m_edgeVertices.size(); i++)
+		edgeStar[fill[m_edgeVertices[i]]++] = i / 2;
+
+	m_vertexEdgeOffsets.resize(m_numVertices + 1);
+	m_vertexFaceOffsets.resize(m_numVertices + 1);
+	m_vertexEdges.reserve(edgeStar.size());
+	m_vertexFaces.reserve(numSides);
+	m_onBoundary.assign(m_numVertices, false);
+
+	std::vector <int> inEdges, outEdges;
+	std::vector <bool> used;
+
+	for (unsigned int v = 0; v < m_numVertices; v++) {
+		m_vertexEdgeOffsets[v] = (int)m_vertexEdges.size();
+		m_vertexFaceOffsets[v] = (int)m_vertexFaces.size();
+
+		// Every corner enters the vertex through one edge and leaves it through another
+		unsigned int numCorners = cornerOffsets[v + 1] - cornerOffsets[v];
+		inEdges.resize(numCorners);
+		outEdges.resize(numCorners);
+		used.assign(numCorners, false);
+		for (unsigned int c = 0; c < numCorners; c++) {
+			int side = corners[cornerOffsets[v] + c];
+			unsigned int face = sideFace[side], offset = m_faceOffsets[face], count = faceCount(face);
+			outEdges[c] = m_faceEdges[side];
+			inEdges[c] = m_faceEdges[offset + (side - offset + count - 1) % count];
+		}
+
+		// Chain corners into fans, open fans start on a boundary edge
+		unsigned int numFans = 0, numUsed = 0;
+		while (numUsed < numCorners) {
+			int start = -1;
+			for (unsigned int c = 0; c < numCorners && start < 0; c++) {
+				if (used[c])
+					continue;
+				bool isOpen = true;
+				for (unsigned int o = 0; o < numCorners; o++)
+					if (o != c && inEdges[o] == outEdges[c]) {
+						isOpen = false;
+						break;
+					}
+				if (isOpen) {
+					start = c;
+					m_onBoundary[v] = true;
+				}
+			}
+			if (start < 0)
+				for (unsigned int c = 0; c < numCorners && start < 0; c++)
+					if (!used[c])
+						start = c;
+
+			int firstEdge = outEdges[start], current = start;
+			m_vertexEdges.push_back(firstEdge);
+			while (0 <= current) {
+				used[current] = true;
+				numUsed++;
+				m_vertexFaces.push_back(sideFace[corners[cornerOffsets[v] + current]]);
+
+				int nextEdge = inEdges[current];
+				current = -1;
+				for (unsigned int c = 0; c < numCorners; c++)
+					if (!used[c] && outEdges[c] == nextEdge) {
+						current = c;
+						break;
+					}
+
+				if (0 <= current || nextEdge != firstEdge)
+					m_vertexEdges.push_back(nextEdge);
+				if (current < 0 && nextEdge != firstEdge)
+					m_onBoundary[v] = true;
+			}
+			numFans++;
+		}
+		if (1 < numFans)
+			m_onBoundary[v] = true;
+
+		// Edges without faces go last
+		for (int i = edgeOffsets[v]; i < edgeOffsets[v + 1]; i++) {
+			int edge = edgeStar[i];
+			if (std::find(m_vertexEdges.begin() + m_vertexEdgeOffsets[v], m_vertexEdges.end(), edge) == m_vertexEdges.end()) {
+				m_vertexEdges.push_back(edge);
+				m_onBoundary[v] = true;
+			}
+		}
+	}
+
+	m_vertexEdgeOffsets[m_numVertices] = (int)m_vertexEdges.size();
+	m_vertexFaceOffsets[m_numVertices] = (int)m_vertexFaces.size();
+}
\ No newline at end of file
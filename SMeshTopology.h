@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+
+// Flat (CSR) adjacency of a polygon mesh. Built in one pass from face counts/indices and
+// optionally the edge list of the source mesh. When no edge list is given, edges are numbered
+// in the order of their first use while walking faces, which is the order MFnMesh::create uses.
+//
+// Around every vertex edges are stored in winding order and face i lies between edge i and
+// edge i+1. On boundary vertices the first and the last edge are boundary edges.
+class SMeshTopology
+{
+public:
+	SMeshTopology();
+	~SMeshTopology();
+
+	bool build(unsigned int numVertices, const std::vector<int> &counts, const std::vector<int> &indices, const std::vector<int> &edgeVertices = std::vector<int>());
+	void clear();
+	bool isNull() const;
+
+	unsigned int numVertices() const;
+	unsigned int numEdges() const;
+	unsigned int numFaces() const;
+	unsigned int numFaceVertices() const;
+
+	// Fingerprint of vertex, edge and face counts and face indices, computed once per build
+	unsigned long long hash() const;
+	static unsigned long long hash(unsigned int numVertices, unsigned int numEdges, const int *counts, unsigned int numFaces, const int *indices, unsigned int numIndices);
+
+	// Vertex queries
+	unsigned int numConnectedEdges(const unsigned int vertex) const;
+	const int *connectedEdges(const unsigned int vertex) const;
+	unsigned int numConnectedFaces(const unsigned int vertex) const;
+	const int *connectedFaces(const unsigned int vertex) const;
+	bool onBoundary(const unsigned int vertex) const;
+	int oppositeVertex(const unsigned int vertex, const unsigned int edge) const;
+	int relativeEdgeIndex(const unsigned int vertex, const unsigned int edge) const;
+
+	// Edge queries
+	void getEdgeVertices(const unsigned int edge, int vertices[2]) const;
+	int edgeVertex(const unsigned int edge, const unsigned int end) const;
+	unsigned int numEdgeFaces(const unsigned int edge) const;
+	const int *edgeFaces(const unsigned int edge) const;
+	bool edgeOnBoundary(const unsigned int edge) const;
+	int findEdge(const unsigned int vertexA, const unsigned int vertexB) const;
+
+	// Face queries
+	unsigned int faceOffset(const unsigned int face) const;
+	unsigned int faceCount(const unsigned int face) const;
+	const int *faceVertices(const unsigned int face) const;
+	const int *faceEdges(const unsigned int face) const;
+
+	// Component grouping, groups are returned as offsets into a flat element list
+	bool groupConnectedFaces(const std::vector<int> &faces, std::vector<int> &groupOffsets, std::vector<int> &groupElements, bool parallel = true) const;
+	bool groupConnectedVertices(const std::vector<int> &vertices, std::vector<int> &groupOffsets, std::vector<int> &groupElements, bool parallel = true) const;
+
+	// Edge loops through the listed edges, continued straight across regular vertices. Loops are
+	// returned as offsets into flat edge and orientation lists, a flipped edge runs from its
+	// second vertex to its first.
+	bool findEdgeLoops(const std::vector<int> &edges, std::vector<int> &loopOffsets, std::vector<int> &loopEdges, std::vector<bool> &loopFlipped) const;
+
+protected:
+	unsigned int m_numVertices = 0;
+	unsigned long long m_hash = 0;
+
+	std::vector <int>
+		m_faceOffsets,
+		m_faceVertices,
+		m_faceEdges,
+		m_edgeVertices,
+		m_edgeFaceOffsets,
+		m_edgeFaces,
+		m_vertexEdgeOffsets,
+		m_vertexEdges,
+		m_vertexFaceOffsets,
+		m_vertexFaces;
+
+	std::vector <bool> m_onBoundary;
+
+	bool generateEdges();
+	bool assignFaceEdges();
+	void buildEdgeFaces();
+	void buildVertexStars();
+
+	int nextLoopEdge(const unsigned int vertex, const std::vector<bool> &remainingEdges, const int firstEdge, const int lastEdge, bool &isValid) const;
+
+	template <typename Neighbors>
+	static bool groupConnected(unsigned int numElements, const std::vector<int> &elements, Neighbors neighbors, std::vector<int> &groupOffsets, std::vector<int> &groupElements, bool parallel);
+};
\ No newline at end of file
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <algorithm>
+
+class SParallel
+{
+public:
+	SParallel() {};
+	~SParallel() {};
+
+	static unsigned int numThreads() {
+		unsigned int threads = std::thread::hardware_concurrency();
+		return (0 < threads) ? threads : 1;
+	};
+
+	// True on threads working for a parallel call. Calls nested in one run serially on their thread
+	// instead of starting threads of their own, so the thread count never multiplies.
+	static bool isNested() {
+		return nestedFlag();
+	};
+
+	// Number of chunks worth splitting a range into, never less than one
+	static unsigned int numChunks(unsigned int size, unsigned int minChunkSize) {
+		if (isNested())
+			return 1;
+		if (minChunkSize == 0)
+			minChunkSize = 1;
+		unsigned int chunks = std::min(numThreads(), size / minChunkSize);
+		return (0 < chunks) ? chunks : 1;
+	};
+
+	// Calls function(chunk, begin, end) for contiguous chunks of [0, size). The first chunk runs
+	// on the calling thread.
+	template <typename Function>
+	static void forChunks(unsigned int size, unsigned int chunks, Function function) {
+		if (chunks < 2 || size < chunks || isNested()) {
+			function(0u, 0u, size);
+			return;
+		}
+
+		NestedScope scope;
+		std::vector <std::thread> threads;
+		threads.reserve(chunks - 1);
+		for (unsigned int c = 1; c < chunks; c++)
+			threads.push_back(std::thread([&function](unsigned int chunk, unsigned int begin, unsigned int end) {
+				NestedScope workerScope;
+				function(chunk, begin, end);
+			}, c, chunkBegin(size, chunks, c), chunkBegin(size, chunks, c + 1)));
+
+		function(0u, 0u, chunkBegin(size, chunks, 1));
+
+		for (auto &thread : threads)
+			thread.join();
+	};
+
+	// Calls function(index) for every index of [0, size) on a pool of threads. Every thread owns a
+	// contiguous block of indices, takes work from the back of its own queue and steals from the
+	// front of the others once it runs dry. The calling thread is one of the workers.
+	template <typename Function>
+	static void forEach(unsigned int size, unsigned int threads, Function function) {
+		threads = std::min(threads, size);
+		if (threads < 2 || isNested()) {
+			for (unsigned int i = 0; i < size; i++)
+				function(i);
+			return;
+		}
+
+		std::vector <std::deque<unsigned int>> queues(threads);
+		std::vector <std::mutex> mutexes(threads);
+		for (unsigned int t = 0; t < threads; t++)
+			for (unsigned int i = chunkBegin(size, threads, t); i < chunkBegin(size, threads, t + 1); i++)
+				queues[t].push_back(i);
+
+		// No work is added while running, a worker that finds every queue empty is done
+		auto worker = [&](unsigned int thread) {
+			while (true) {
+				unsigned int index = 0;
+				bool found = false;
+
+				{
+					std::lock_guard <std::mutex> lock(mutexes[thread]);
+					if (!queues[thread].empty()) {
+						index = queues[thread].back();
+						queues[thread].pop_back();
+						found = true;
+					}
+				}
+
+				for (unsigned int o = 1; !found && o < threads; o++) {
+					unsigned int victim = (thread + o) % threads;
+					std::lock_guard <std::mutex> lock(mutexes[victim]);
+					if (!queues[victim].empty()) {
+						index = queues[victim].front();
+						queues[victim].pop_front();
+						found = true;
+					}
+				}
+
+				if (!found)
+					return;
+
+				function(index);
+			}
+		};
+
+		NestedScope scope;
+		std::vector <std::thread> workers;
+		workers.reserve(threads - 1);
+		for (unsigned int t = 1; t < threads; t++)
+			workers.push_back(std::thread([&worker](unsigned int thread) {
+				NestedScope workerScope;
+				worker(thread);
+			}, t));
+
+		worker(0u);
+
+		for (auto &thread : workers)
+			thread.join();
+	};
+
+	static unsigned int chunkBegin(unsigned int size, unsigned int chunks, unsigned int chunk) {
+		return (unsigned int)((unsigned long long)size * chunk / chunks);
+	};
+
+private:
+	static bool &nestedFlag() {
+		static thread_local bool nested = false;
+		return nested;
+	};
+
+	// Marks the current thread as working for a parallel call until the scope ends
+	struct NestedScope
+	{
+		bool previous;
+
+		NestedScope() : previous(nestedFlag()) {
+			nestedFlag() = true;
+		};
+		~NestedScope() {
+			nestedFlag() = previous;
+		};
+	};
+};
\ No newline at end of file
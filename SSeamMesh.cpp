@@ -1,4 +1,5 @@
 #include "SSeamMesh.h"
+#include "SEdgeGrid.h"
 
 SSeamMesh::SSeamMesh() {};
 
@@ -10,51 +11,63 @@ SSeamMesh::SSeamMesh(SMesh &mesh) :SMesh(mesh) {
 
 SSeamMesh::SSeamMesh(const SSeamMesh &mesh) :SMesh(mesh) {
 	m_edgeMap = mesh.m_edgeMap;
+	m_reverseEdgeMap = mesh.m_reverseEdgeMap;
 };
 
 SSeamMesh& SSeamMesh::operator=(const SSeamMesh& mesh) {
 	SMesh::operator=(mesh);
 	m_edgeMap = mesh.m_edgeMap;
+	m_reverseEdgeMap = mesh.m_reverseEdgeMap;
 	return *this;
 }
 
 SSeamMesh::~SSeamMesh() {
 }
 
+// Packs an unordered vertex pair into a single hash key
+static unsigned long long vertexPairKey(unsigned int vertexA, unsigned int vertexB) {
+	if (vertexB < vertexA)
+		std::swap(vertexA, vertexB);
+	return ((unsigned long long)vertexA << 32) | vertexB;
+}
+
 MStatus SSeamMesh::transferEdges(const MObject& sourceMesh, const MIntArray &edges) {
 	MStatus status;
 
-	MFnMesh fnSrcMesh(sourceMesh);
-	MFnMesh fnTrgMesh(m_mesh);
-
-	std::map <unsigned int, std::set<unsigned int>> srcEdges, trgEdges;
+	MFnMesh fnSrcMesh(sourceMesh, &status);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
 
-	// Src edge vtx map
+	// Src edges keyed by their vertex pair, the first listed edge wins
+	std::unordered_map <unsigned long long, unsigned int> srcEdges;
+	srcEdges.reserve(edges.length());
 	for (unsigned int e = 0; e < edges.length(); e++) {
 		int vertices[2];
 		status = fnSrcMesh.getEdgeVertices(edges[e], vertices);
 		CHECK_MSTATUS_AND_RETURN_IT(status);
-		srcEdges[e].insert(vertices[0]);
-		srcEdges[e].insert(vertices[1]);
+		srcEdges.emplace(vertexPairKey(vertices[0], vertices[1]), edges[e]);
 	}
 
-	// Trg edge vtx map
-	for (int e = 0; e < fnTrgMesh.numEdges(); e++) {
-		int vertices[2];
-		status = fnTrgMesh.getEdgeVertices(e, vertices);
-		CHECK_MSTATUS_AND_RETURN_IT(status);
-		trgEdges[e].insert(m_vtxMap[vertices[0]]);
-		trgEdges[e].insert(m_vtxMap[vertices[1]]);
-	}
+	const SMeshTopology &trgTopology = topology(&status);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
 
+	if (m_vtxMap.size() < trgTopology.numVertices())
+		resizeVertexMaps(trgTopology.numVertices());
+
+	// Trg edges are looked up through the original vertex ids, both maps are filled in one pass
+	m_reverseEdgeMap.clear();
 	MIntArray newEdges;
-	for (auto &trgEdge : trgEdges)
-		for (auto &srcEdge : srcEdges)
-			if (trgEdge.second == srcEdge.second) {
-				newEdges.append(trgEdge.first);
-				m_edgeMap[trgEdge.first] = edges[srcEdge.first];
-				break;
-			}
+	for (unsigned int e = 0; e < trgTopology.numEdges(); e++) {
+		int vertices[2];
+		trgTopology.getEdgeVertices(e, vertices);
+
+		auto srcEdge = srcEdges.find(vertexPairKey(m_vtxMap[vertices[0]], m_vtxMap[vertices[1]]));
+		if (srcEdge == srcEdges.end())
+			continue;
+
+		newEdges.append(e);
+		m_edgeMap[e] = srcEdge->second;
+		m_reverseEdgeMap[srcEdge->second].push_back(e);
+	}
 
 	status = setActiveEdges(newEdges);
 	CHECK_MSTATUS_AND_RETURN_IT(status);
@@ -62,273 +75,203 @@ MStatus SSeamMesh::transferEdges(const MObject& sourceMesh, const MIntArray &edg
 	return MS::kSuccess;
 }
 
-MStatus SSeamMesh::offsetEdgeloops(float offsetDistance, bool createPolygons) {
+// Spatial matching for targets that were retopologised or smoothed since the seams were cut.
+// Every source edge takes the chain of target edges running closest along it within tolerance,
+// a smoothed edge comes back as the whole chain it was subdivided into.
+MStatus SSeamMesh::transferEdges(const MObject& sourceMesh, const MIntArray &edges, double tolerance) {
 	MStatus status;
 
-	for (auto &loop : m_activeLoops) {
-		status = offsetEdgeloop(loop, offsetDistance, createPolygons);
+	if (tolerance <= 0)
+		return MS::kInvalidParameter;
+
+	MFnMesh fnSrcMesh(sourceMesh, &status);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+
+	const SMeshTopology &trgTopology = topology(&status);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+
+	std::vector <SVec3> trgPoints;
+	if (m_isEditing)
+		trgPoints = m_buffer.points;
+	else {
+		status = SMeshAdapter::getPoints(m_mesh, trgPoints);
 		CHECK_MSTATUS_AND_RETURN_IT(status);
 	}
 
+	std::vector <SVec3>
+		starts(edges.length()),
+		ends(edges.length());
+	for (unsigned int e = 0; e < edges.length(); e++) {
+		int vertices[2];
+		status = fnSrcMesh.getEdgeVertices(edges[e], vertices);
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+
+		MPoint start, end;
+		status = fnSrcMesh.getPoint(vertices[0], start);
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+		status = fnSrcMesh.getPoint(vertices[1], end);
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+		starts[e] = SMeshAdapter::toVec3(start);
+		ends[e] = SMeshAdapter::toVec3(end);
+	}
+
+	SEdgeGrid trgGrid;
+	trgGrid.build(trgTopology, trgPoints);
+
+	// A target edge claimed by several source edges goes to the closest one
+	std::vector <std::vector<unsigned int>> chains;
+	trgGrid.matchSegments(trgTopology, starts, ends, tolerance, chains);
+
+	m_reverseEdgeMap.clear();
+	MIntArray newEdges;
+	for (unsigned int e = 0; e < edges.length(); e++)
+		for (auto &edge : chains[e]) {
+			newEdges.append(edge);
+			m_edgeMap[edge] = edges[e];
+			m_reverseEdgeMap[edges[e]].push_back(edge);
+		}
+
+	status = setActiveEdges(newEdges);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+
 	return MS::kSuccess;
 }
 
-MStatus SSeamMesh::setHardEdges(MIntArray& edges, double tresholdAngle) {
+MStatus SSeamMesh::offsetEdgeloops(float offsetDistance, bool createPolygons) {
 	MStatus status;
 
-	MFnMesh fnMesh(m_mesh);
+	// All loops share one edit, the mesh is rebuilt once at the end
+	bool isImplicit = !m_isEditing;
+	if (isImplicit) {
+		status = beginEdit();
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+	}
 
-	// Put edges in set for faster search
-	std::set <unsigned int> hardEdges;
-	for (unsigned int e = 0; e < edges.length(); e++)
-		hardEdges.insert(edges[e]);
-
-	// Now we're going to generate new ids for vertices on detached edges
-	MItMeshVertex itVertex(m_mesh);
-	MItMeshEdge itEdge(m_mesh);
-	for (itVertex.reset(); !itVertex.isDone(); itVertex.next()) {
-		MIntArray
-			conEdges,
-			conFaces,
-			tmpFaces;
-
-		itVertex.getConnectedEdges(conEdges);
-		itVertex.getConnectedFaces(tmpFaces);
-
-		int
-			numEdges = conEdges.length(),
-			numFaces = tmpFaces.length();
-
-		for (int i = numFaces - 1; i >= 0; i--)
-			conFaces.append(tmpFaces[i]);
-
-		int
-			startEdge = -1,
-			numSplits = 0;
-
-		for (int e = 0; e < numEdges; e++) {
-			if (hardEdges.find(conEdges[e]) != hardEdges.end()) {
-				int prevId;
-				itEdge.setIndex(conEdges[e], prevId);
-				
-				MIntArray edgeConFaces;
-				itEdge.getConnectedFaces(edgeConFaces);
-
-				if (2 != edgeConFaces.length())
-					continue;
-
-				MVector vA, vB;
-				fnMesh.getPolygonNormal(edgeConFaces[0], vA);
-				fnMesh.getPolygonNormal(edgeConFaces[1], vB);
-
-				double angle = M_PI - acos(vA*vB);
-
-				if (tresholdAngle < angle)
-					continue;
-
-				if (startEdge < 0)
-					startEdge = e;
-				numSplits++;
-			}
+	std::vector <std::vector<unsigned int>> loopEdges(m_activeLoops.size());
+	for (unsigned int l = 0; l < m_activeLoops.size(); l++)
+		m_activeLoops[l].get(loopEdges[l]);
+
+	// Loops that don't touch are offset together, a loop touching an earlier one waits for it
+	std::vector <SLoopOffset> offsets;
+	unsigned int begin = 0;
+	while (begin < loopEdges.size()) {
+		unsigned int end = m_buffer.independentLoops(loopEdges, begin);
+		if (!m_buffer.offsetEdgeloops(loopEdges, begin, end, offsetDistance, createPolygons, offsets)) {
+			status = MS::kFailure;
+			break;
 		}
-		if (itVertex.onBoundary())
-			startEdge = 0;
 
-		if ((numSplits == 1 && !itVertex.onBoundary()) || numSplits == 0)
-			continue;
+		for (unsigned int l = begin; l < end; l++)
+			applyLoopOffset(m_activeLoops[l], offsets[l - begin], createPolygons);
 
-		MVector average;
-		MIntArray faces;
-		
-		for (int f = 0; f < numFaces; f++) {
-			int relativeIdx = (startEdge + f) % numFaces;
-
-			if (f!=0 && hardEdges.find(conEdges[relativeIdx]) != hardEdges.end()) {
-				average.normal();
-				for (unsigned int i = 0; i < faces.length(); i++)
-					fnMesh.setFaceVertexNormal(average, faces[i], itVertex.index());
-
-				average = MVector::zero;
-				faces.clear();
-			}
-
-			MVector polyNormal;
-			fnMesh.getPolygonNormal(conFaces[relativeIdx], polyNormal);
-			average += polyNormal;
-			faces.append(conFaces[relativeIdx]);
-		}
+		// Loops waiting for this run may have grown along its new side edges
+		for (unsigned int l = end; l < loopEdges.size(); l++)
+			if (m_activeLoops[l].numEdges() != loopEdges[l].size())
+				m_activeLoops[l].get(loopEdges[l]);
+
+		begin = end;
 	}
 
-	return MS::kSuccess;
+	return endEdit(isImplicit, status);
 }
 
-MStatus SSeamMesh::offsetEdgeloop(SEdgeLoop &edgeLoop, float offsetDistance, bool createPolygons) {
+MStatus SSeamMesh::setHardEdges(MIntArray& edges, double tresholdAngle) {
 	MStatus status;
 
-	MFnMesh fnMesh(m_mesh);
-	int numEdges = fnMesh.numEdges();
-	int numVertices = fnMesh.numVertices();
-	int numFaces = fnMesh.numPolygons();
+	// Face-vertex normals live on the Maya mesh, not in the edit buffer
+	if (m_isEditing)
+		return MS::kFailure;
 
-	MPointArray
-		meshPoints;
-	MIntArray
-		polyCounts,
-		polyIndices;
-	MVectorArray
-		meshNormals;
-
-	fnMesh.getPoints(meshPoints);
-	fnMesh.getVertices(polyCounts, polyIndices);
-	getNormals(meshNormals);
-
-	// Load UV sets
-	SUVSet currentSet(fnMesh.currentUVSetName());
-	status = fnMesh.getUVs(currentSet.U, currentSet.V);
+	MFnMesh fnMesh(m_mesh, &status);
 	CHECK_MSTATUS_AND_RETURN_IT(status);
-	status = fnMesh.getAssignedUVs(currentSet.uvCounts, currentSet.uvIndices);
+
+	// Points and faces are enough, normals are classified and averaged in the buffer
+	SMeshBuffer buffer;
+	status = SMeshAdapter::getPoints(m_mesh, buffer.points);
 	CHECK_MSTATUS_AND_RETURN_IT(status);
 
-	MItMeshVertex itVertex(m_mesh);
+	MIntArray polyCounts, polyIndices;
+	status = fnMesh.getVertices(polyCounts, polyIndices);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+	SMeshAdapter::toIntVector(polyCounts, buffer.counts);
+	SMeshAdapter::toIntVector(polyIndices, buffer.indices);
 
-	bool isClosedEnd = false;
-	bool isCrossedEnd = false;
-	int firstVtxId = -1;
-	int lastEdge;
-	unsigned int lastElement = edgeLoop.numEdges() - 1;
-	MPoint tmpFirstPoint;
+	const SMeshTopology &meshTopology = topology(&status);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
+	buffer.setTopology(meshTopology);
 
-	for (unsigned int l = 0; l < edgeLoop.numEdges(); l++) {
+	std::vector <int> hardEdges, faceIds, vertexIds;
+	std::vector <SVec3> faceVertexNormals;
+	SMeshAdapter::toIntVector(edges, hardEdges);
+	if (!buffer.hardEdgeNormals(hardEdges, tresholdAngle, faceIds, vertexIds, faceVertexNormals))
+		return MS::kInvalidParameter;
 
-		int vertices[2];
-		fnMesh.getEdgeVertices(edgeLoop[l], vertices);
-
-		bool isLast = false;
-
-		// Duplicate and move original point	
-		for (int v = (l == 0) ? 0 : 1; v < 2 ; v++) {
-			bool isFirst = (l == 0 && v == 0);
-			isLast = (l == lastElement && v==1);
-
-			int vtxId = vertices[v], previousVtx;
-			status = itVertex.setIndex(vtxId, previousVtx);
-			CHECK_MSTATUS_AND_RETURN_IT(status);
-
-			if (!itVertex.onBoundary())
-				return MS::kFailure;
-
-			MIntArray conEdges;
-			itVertex.getConnectedEdges(conEdges);
-
-			if (isFirst && 1<edgeLoop.numEdges() && itVertex.connectedToEdge(edgeLoop[lastElement])) {
-				if (conEdges.length() == 2)
-					isCrossedEnd = true;
-				else
-					isClosedEnd = true;
-			}
-
-			if (isLast && isClosedEnd)
-				break;
-
-			// Set face vertex normals
-			if (createPolygons) {
-				MPoint newPoint = meshPoints[vtxId];
-
-				if (isCrossedEnd && isFirst) {
-					tmpFirstPoint = newPoint;
-					firstVtxId = vtxId;
-					MVector direction = getEdgeVector(conEdges[0], vtxId).normal();
-					newPoint += direction*offsetDistance;
-				}
-
-				meshPoints.append(newPoint);
-				meshNormals.append(meshNormals[vtxId]);
-			}
-
-			MVector direction;
-			if (isFirst && !isClosedEnd)
-				direction = getEdgeVector(conEdges[conEdges.length() - 1], vtxId).normal();
-			else if (isLast && !isClosedEnd)
-				direction = getEdgeVector(conEdges[0], vtxId).normal();
-			else
-				for (unsigned int e = 1; e < conEdges.length() - 1; e++)
-					direction += getEdgeVector(conEdges[e], vtxId).normal();
-			meshPoints[vtxId] += direction.normal()*offsetDistance;
-
-			if (createPolygons && !isClosedEnd && !isCrossedEnd) {
-				for (auto &conLoop : m_activeLoops) {
-					if (isFirst) {
-						if (conLoop.contains(conEdges[conEdges.length() - 1]))
-							conLoop.pushBack(numEdges);
-					}
-					if (isLast) {
-						if (conLoop.contains(conEdges[0]))
-							conLoop.pushFront(numEdges + 2 * edgeLoop.numEdges());
-					}
-				}
-			}
-
-			
-		}
+	if (faceIds.size() == 0)
+		return MS::kSuccess;
 
-		if (createPolygons) {
-			// Define new polygon
-			polyIndices.append(vertices[0]);
-			polyIndices.append(numVertices + l);
-			polyIndices.append((isLast && isClosedEnd) ? numVertices : numVertices + l + 1);
-			polyIndices.append(vertices[1]);
-			polyCounts.append(4);
-			currentSet.addPolygon();
-
-			// Udate edge loop id
-			edgeLoop[l] = lastEdge = 2 * l + 1 + numEdges;
-		}
-	}
+	// One call, Maya updates its normal data once
+	MVectorArray normals;
+	SMeshAdapter::toVectorArray(faceVertexNormals, normals);
+	MIntArray
+		faces = SMeshAdapter::toIntArray(faceIds),
+		vertices = SMeshAdapter::toIntArray(vertexIds);
+	status = fnMesh.setFaceVertexNormals(normals, faces, vertices);
+	CHECK_MSTATUS_AND_RETURN_IT(status);
 
+	return MS::kSuccess;
+}
 
-	if (isCrossedEnd && createPolygons) {
-		polyIndices.append(meshPoints.length() - 1);
-		polyIndices.append(meshPoints.length());
-		polyIndices.append(numVertices);
-		polyIndices.append(firstVtxId);
+MStatus SSeamMesh::offsetEdgeloop(SEdgeLoop &edgeLoop, float offsetDistance, bool createPolygons) {
+	MStatus status;
 
-		polyCounts.append(4);
-		currentSet.addPolygon();
+	bool isImplicit = !m_isEditing;
+	if (isImplicit) {
+		status = beginEdit();
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+	}
 
-		meshPoints.append(tmpFirstPoint);
-		meshNormals.append(meshNormals[firstVtxId]);
+	return endEdit(isImplicit, offsetEdgeloop(m_buffer, edgeLoop, offsetDistance, createPolygons));
+}
 
-		edgeLoop.pushFront(lastEdge + 3);
-		edgeLoop.pushBack(lastEdge + 2);
-	}
+MStatus SSeamMesh::offsetEdgeloop(SMeshBuffer &buffer, SEdgeLoop &edgeLoop, float offsetDistance, bool createPolygons) {
+	std::vector <unsigned int> loopEdges;
+	edgeLoop.get(loopEdges);
 
-	if (createPolygons) {
-		// Update mesh
-		fnMesh.create(
-			meshPoints.length(),
-			polyCounts.length(),
-			meshPoints,
-			polyCounts,
-			polyIndices,
-			currentSet.U,
-			currentSet.V,
-			m_mesh,
-			&status
-		);
-		CHECK_MSTATUS_AND_RETURN_IT(status);
+	SLoopOffset offset;
+	if (!buffer.offsetEdgeloop(loopEdges, offsetDistance, createPolygons, offset))
+		return MS::kFailure;
 
-		status = fnMesh.assignUVs(currentSet.uvCounts, currentSet.uvIndices);
-		CHECK_MSTATUS_AND_RETURN_IT(status);
+	applyLoopOffset(edgeLoop, offset, createPolygons);
+
+	return MS::kSuccess;
+}
+
+void SSeamMesh::applyLoopOffset(SEdgeLoop &edgeLoop, const SLoopOffset &offset, bool createPolygons) {
+	if (!createPolygons)
+		return;
 
-		status = setNormals(meshNormals);
-		CHECK_MSTATUS_AND_RETURN_IT(status)
+	// Loops running into the ends of this one continue along the new side edges
+	for (auto &conLoop : m_activeLoops) {
+		if (&conLoop == &edgeLoop)
+			continue;
+		if (0 <= offset.firstOuterEdge && conLoop.contains(offset.firstOuterEdge))
+			conLoop.pushBack(offset.firstNewEdge);
+		if (0 <= offset.lastOuterEdge && conLoop.contains(offset.lastOuterEdge))
+			conLoop.pushFront(offset.lastNewEdge);
 	}
-	else
-		fnMesh.setPoints(meshPoints);
 
-	return MS::kSuccess;
+	// Udate edge loop ids
+	edgeLoop.setEdges(offset.edges);
+	if (0 <= offset.frontEdge)
+		edgeLoop.pushFront(offset.frontEdge);
+	if (0 <= offset.backEdge)
+		edgeLoop.pushBack(offset.backEdge);
 }
 
 void SSeamMesh::getEdgeMap(std::map <unsigned int, unsigned int> &edgeMap) {
 	edgeMap = m_edgeMap;
+}
+
+void SSeamMesh::getReverseEdgeMap(std::unordered_map <unsigned int, std::vector<unsigned int>> &reverseEdgeMap) {
+	reverseEdgeMap = m_reverseEdgeMap;
 }
\ No newline at end of file
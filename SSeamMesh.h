@@ -2,6 +2,8 @@
 
 #include "SMesh.h"
 
+#include <unordered_map>
+
 class SSeamMesh : public SMesh
 {
 public:
@@ -13,12 +15,19 @@ public:
 	~SSeamMesh();
 
 	MStatus transferEdges(const MObject& sourceMesh, const MIntArray &edges);
+	MStatus transferEdges(const MObject& sourceMesh, const MIntArray &edges, double tolerance);
 	MStatus offsetEdgeloop(SEdgeLoop &edgeLoop, float offsetDistance, bool createPolygons = true);
 	MStatus offsetEdgeloops(float offsetDistance, bool createPolygons = true);
 	MStatus setHardEdges(MIntArray& edges, double tresholdAngle);
 
 	void	getEdgeMap(std::map <unsigned int, unsigned int> &edgeMap);
+	// Source edge to the target edges it was transferred to by the last transferEdges
+	void	getReverseEdgeMap(std::unordered_map <unsigned int, std::vector<unsigned int>> &reverseEdgeMap);
 
 protected:
 	std::map <unsigned int, unsigned int> m_edgeMap;
+	std::unordered_map <unsigned int, std::vector<unsigned int>> m_reverseEdgeMap;
+
+	MStatus offsetEdgeloop(SMeshBuffer &buffer, SEdgeLoop &edgeLoop, float offsetDistance, bool createPolygons);
+	void applyLoopOffset(SEdgeLoop &edgeLoop, const SLoopOffset &offset, bool createPolygons);
 };
\ No newline at end of file
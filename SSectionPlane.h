@@ -1,14 +1,16 @@
 #pragma once
 #include "SPlane.h"
+#include "SMeshSection.h"
+#include "SMeshAdapter.h"
+#include "SMesh.h"
 
-#include <maya\MItMeshPolygon.h>
-#include <maya\MItMeshEdge.h>
-#include <maya\MItMeshVertex.h>
 #include <maya\MFnNurbsCurveData.h>
 #include <maya\MFnNurbsCurve.h>
+#include <maya\MDoubleArray.h>
+#include <maya\MObjectArray.h>
 
-#include <set>
-#include <map>
+#include <vector>
+#include <algorithm>
 
 class SSectionPlane : public SPlane{
 public:
@@ -24,184 +26,254 @@ public:
 		
 		curves.clear();
 
-		if (mesh.apiType() != MFn::kMesh &&
-			mesh.apiType() != MFn::kMeshData &&
-			mesh.apiType() != MFn::kMeshGeom)
+		status = setMesh(mesh, transform);
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+
+		return getIntersections(curves);
+	}
+
+	// Sections the mesh given to setMesh, meant for redrawing while only the plane moves
+	MStatus getIntersections(MObjectArray& curves) {
+		MStatus status;
+
+		curves.clear();
+
+		if (!m_hasMesh)
 			return MS::kInvalidParameter;
 
 		clear();
 
-		status = generatePlaneSections(mesh, transform, curves);
+		status = generatePlaneSections(curves);
 		CHECK_MSTATUS_AND_RETURN_IT(status);
 
 		return MS::kSuccess;
 	}
 
-	static MStatus generateNurbsCurve(MPointArray& editPoints, MFnNurbsCurve::Form form, MObject& curveData) {
+	// Keeps the transformed points of the mesh for the following sections. The topology is only
+	// rebuilt when the topology hash of the mesh changes, the face hierarchy used for culling
+	// when the topology or any point changes.
+	MStatus setMesh(MObject &mesh, const MMatrix &transform = MMatrix::identity) {
 		MStatus status;
 
-		if (2 > editPoints.length() || (MFnNurbsCurve::kClosed==form && 3>editPoints.length()))
+		if (mesh.apiType() != MFn::kMesh &&
+			mesh.apiType() != MFn::kMeshData &&
+			mesh.apiType() != MFn::kMeshGeom)
 			return MS::kInvalidParameter;
 
-		MFnNurbsCurveData fnCurveData;
-		curveData = fnCurveData.create(&status);
-		CHECK_MSTATUS_AND_RETURN_IT(status);
+		m_hasMesh = false;
 
-		MFnNurbsCurve fnCurve;
-		fnCurve.createWithEditPoints(editPoints, 1, form, false, false, true, curveData, &status);
+		unsigned long long hash;
+		status = SMesh::getTopologyHash(mesh, hash);
 		CHECK_MSTATUS_AND_RETURN_IT(status);
 
-		return MS::kSuccess;
-	}
+		if (m_topology.isNull() || m_topology.hash() != hash) {
+			m_isTreeValid = false;
+			status = SMeshAdapter::getTopology(mesh, m_topology);
+			CHECK_MSTATUS_AND_RETURN_IT(status);
+		}
 
-protected:
-	std::set<unsigned int> m_intersectingEdges;
-	std::map<unsigned int, bool> m_isEdgeOnBoundary;
-	std::map<unsigned int, double> m_intersectionParameters;
-	std::map<unsigned int, MPoint> m_intersectionPoints;
+		std::vector <SVec3> points;
+		status = SMeshAdapter::getPoints(mesh, points, transform);
+		CHECK_MSTATUS_AND_RETURN_IT(status);
+		if (points != m_points) {
+			m_isTreeValid = false;
+			m_points.swap(points);
+		}
 
-	void clear() {
-		m_intersectingEdges.clear();
-		m_intersectionParameters.clear();
-		m_intersectionPoints.clear();
-		m_isEdgeOnBoundary.clear();
+		m_hasMesh = true;
+
+		return MS::kSuccess;
 	}
 
-	MStatus generatePlaneSections(MObject &mesh, MMatrix &transform, MObjectArray &sectionCurves) {
-		MStatus status;
+	// Contours of the mesh given to setMesh as flat polylines in the space of its transform, no
+	// curves are created. Layout as in SMeshSection::getPolylines, buffers are reused.
+	MStatus getPolylines(std::vector <unsigned int> &offsets, std::vector <SVec3> &points, std::vector <bool> &closed, std::vector <int> &edges, std::vector <double> &parameters) {
+		if (!m_hasMesh)
+			return MS::kInvalidParameter;
 
-		// Iterators
-		MItMeshPolygon itPolygon(mesh, &status);
-		CHECK_MSTATUS_AND_RETURN_IT(status);
-		MItMeshEdge itEdge(mesh, &status);
-		CHECK_MSTATUS_AND_RETURN_IT(status);
-		MItMeshVertex itVertex(mesh, &status);
-		CHECK_MSTATUS_AND_RETURN_IT(status);
+		clear();
 
-		//Find intersections
-		status = findIntersections(mesh, transform);
-		CHECK_MSTATUS_AND_RETURN_IT(status);
+		if (!computeSection())
+			return MS::kFailure;
+		simplifyContours();
 
-		// Sort intersections and create curves
-		while (0<m_intersectingEdges.size()) {
-			auto first = *m_intersectingEdges.begin();
+		m_section.getPolylines(offsets, points, closed, edges, parameters);
 
-			for (auto iter : m_intersectingEdges)
-				if (m_isEdgeOnBoundary[iter]) {
-					first = iter;
-					break;
-				}
+		return MS::kSuccess;
+	}
 
-			MIntArray sortedEdges;
-			bool isClosed;
-			status = sortIntersections(first, itPolygon, itEdge, itVertex, sortedEdges, isClosed);
-			CHECK_MSTATUS_AND_RETURN_IT(status);
+	bool hasMesh() const {
+		return m_hasMesh;
+	}
 
-			if (2 > sortedEdges.length())
-				continue;
+	// Contours are simplified to tolerance before any output, 0 keeps every point. Degree 3
+	// fits cubic curves through the remaining points instead of linear ones.
+	void setSimplification(double tolerance, int degree = 1) {
+		m_tolerance = std::max(0.0, tolerance);
+		m_degree = (3 == degree) ? 3 : 1;
+	}
 
-			MPointArray sectionPoints;
-			for (unsigned int i = 0; i < sortedEdges.length(); i++)
-				if(0 == sectionPoints.length() || !sectionPoints[sectionPoints.length()-1].isEquivalent(m_intersectionPoints[sortedEdges[i]], 0.01))
-					sectionPoints.append(m_intersectionPoints[sortedEdges[i]]);
-			if (isClosed && sectionPoints[0] != sectionPoints[sectionPoints.length() - 1])
-				sectionPoints.append(sectionPoints[0]);
+	// Single plane sections march faces in parallel, the contours are the same
+	void setParallel(bool parallel) {
+		m_isParallel = parallel;
+	}
 
-			if (2 > sectionPoints.length() || (isClosed && 3 > sectionPoints.length()))
-				continue;
+	// Single plane sections only visit faces whose bounds the plane touches. Worth it when the
+	// plane crosses a small part of a large mesh and the mesh stays put between sections.
+	void setCulling(bool culling) {
+		m_isCulling = culling;
+	}
 
-			MObject sectionCurve;
-			status = generateNurbsCurve(sectionPoints, (isClosed) ? MFnNurbsCurve::kClosed : MFnNurbsCurve::kOpen, sectionCurve);
-			CHECK_MSTATUS_AND_RETURN_IT(status);
-			if(!sectionCurve.isNull())
-				sectionCurves.append(sectionCurve);
-		}
+	// Largest distance of a dropped point from the curves of the last section. Cubic curves are
+	// measured directly, for linear ones this is the chordal deviation.
+	double maxDeviation() const {
+		return m_maxDeviation;
+	}
 
-		return MS::kSuccess;
+	// Largest distance of a dropped point from the simplified polylines of the last section
+	double chordalDeviation() const {
+		return m_chordalDeviation;
 	}
 
-	MStatus findIntersections(MObject& mesh, MMatrix& transform){
+	// Sections at every offset along the plane normal, one curve array per offset
+	MStatus getSlices(MObject &mesh, const MDoubleArray &offsets, std::vector <MObjectArray> &curves, const MMatrix &transform = MMatrix::identity) {
 		MStatus status;
 
-		MItMeshEdge itEdge(mesh, &status);
+		curves.assign(offsets.length(), MObjectArray());
+
+		status = setMesh(mesh, transform);
 		CHECK_MSTATUS_AND_RETURN_IT(status);
 
-		for (itEdge.reset(); !itEdge.isDone(); itEdge.next()) {
-			double parameter;
-			MPoint intersection;
+		clear();
 
-			MPoint pointA = itEdge.point(0)*transform;
-			MPoint pointB = itEdge.point(1)*transform;
-			MVector direction = pointB - pointA;
+		std::vector <double> planeOffsets(offsets.length());
+		for (unsigned int i = 0; i < offsets.length(); i++)
+			planeOffsets[i] = offsets[i];
 
-			if (!intersect(pointA, direction, intersection, parameter))
-				continue;
+		if (!m_section.computeSlices(m_topology, m_points, SMeshAdapter::toVec3(m_origin), SMeshAdapter::toVec3(m_normal), planeOffsets))
+			return MS::kFailure;
+		simplifyContours();
 
-			unsigned int index = itEdge.index();
-			m_intersectingEdges.insert(index);
-			m_isEdgeOnBoundary[index] = itEdge.onBoundary();
-			m_intersectionParameters[index] = parameter;
-			m_intersectionPoints[index] = intersection;
+		for (unsigned int c = 0; c < m_section.numContours(); c++) {
+			status = appendContourCurve(c, curves[m_section.contourPlane(c)]);
+			CHECK_MSTATUS_AND_RETURN_IT(status);
 		}
 
 		return MS::kSuccess;
 	}
 
-	MStatus sortIntersections(unsigned int currentEdge, MItMeshPolygon &itPolygon, MItMeshEdge &itEdge, MItMeshVertex &itVertex, MIntArray& sortedEdges, bool &isClosed) {
+	static MStatus generateNurbsCurve(MPointArray& editPoints, MFnNurbsCurve::Form form, MObject& curveData, unsigned int degree = 1) {
 		MStatus status;
 
-		sortedEdges.append(currentEdge);
-		m_intersectingEdges.erase(currentEdge);
-
-		MIntArray connectedFaces;
-		bool onBoundary;
-		int dummyIndex;
+		if (2 > editPoints.length() || (MFnNurbsCurve::kClosed==form && 3>editPoints.length()))
+			return MS::kInvalidParameter;
 
-		status = itEdge.setIndex(currentEdge, dummyIndex);
+		MFnNurbsCurveData fnCurveData;
+		curveData = fnCurveData.create(&status);
 		CHECK_MSTATUS_AND_RETURN_IT(status);
-		onBoundary = itEdge.onBoundary(&status);
+
+		MFnNurbsCurve fnCurve;
+		fnCurve.createWithEditPoints(editPoints, std::min(degree, editPoints.length() - 1), form, false, false, true, curveData, &status);
 		CHECK_MSTATUS_AND_RETURN_IT(status);
 
-		// If inersection on vertex, get rid of faces sharing this vertex
-		double parameter = m_intersectionParameters[currentEdge];
-		if (1==parameter || 0==parameter) {
-			status = itVertex.setIndex(itEdge.index(int(parameter)), dummyIndex);
-			CHECK_MSTATUS_AND_RETURN_IT(status);
-			status = itVertex.getConnectedFaces(connectedFaces);
-			CHECK_MSTATUS_AND_RETURN_IT(status);
-			clearConnected(itVertex);
-		}
-		else {
-			itEdge.getConnectedFaces(connectedFaces, &status);
-			CHECK_MSTATUS_AND_RETURN_IT(status);
+		return MS::kSuccess;
+	}
+
+protected:
+	SMeshSection m_section;
+
+	// Session data, see setMesh
+	SMeshTopology m_topology;
+	std::vector <SVec3> m_points;
+	bool m_hasMesh = false;
+	SFaceBVH m_tree;
+	bool m_isTreeValid = false;
+
+	bool m_isParallel = false;
+	bool m_isCulling = false;
+	double m_tolerance = 0;
+	int m_degree = 1;
+	double m_maxDeviation = 0;
+	double m_chordalDeviation = 0;
+	std::vector <unsigned int> m_sourceOffsets;
+	std::vector <SVec3> m_sourcePoints;
+	std::vector <bool> m_sourceClosed;
+	std::vector <int> m_sourceEdges;
+	std::vector <double> m_sourceParameters;
+
+	void clear() {
+		m_section.clear();
+		m_maxDeviation = 0;
+		m_chordalDeviation = 0;
+	}
+
+	// Only the signed distances and the chaining depend on the plane
+	bool computeSection() {
+		m_section.setPlane(SMeshAdapter::toVec3(m_origin), SMeshAdapter::toVec3(m_normal));
+		if (m_isCulling) {
+			if (!m_isTreeValid) {
+				m_tree.build(m_topology, m_points);
+				m_isTreeValid = true;
+			}
+			return m_section.compute(m_topology, m_points, m_tree);
 		}
+		if (m_isParallel)
+			return m_section.computeMarching(m_topology, m_points);
+		return m_section.compute(m_topology, m_points);
+	}
 
-		// Iterate over connected faces, looking for next intersection
-		for (unsigned int f = 0; f<connectedFaces.length(); f++) {
-			status = itPolygon.setIndex(connectedFaces[f], dummyIndex);
-			CHECK_MSTATUS_AND_RETURN_IT(status);
+	// Unsimplified contours are kept when cubic curves have to be measured against them
+	void simplifyContours() {
+		if (0 == m_tolerance)
+			return;
+
+		if (3 == m_degree)
+			m_section.getPolylines(m_sourceOffsets, m_sourcePoints, m_sourceClosed, m_sourceEdges, m_sourceParameters);
+		m_chordalDeviation = m_section.simplify(m_tolerance);
 
-			MIntArray connectedEdges;
-			status = itPolygon.getEdges(connectedEdges);
+		// The cubic can stay closer or pass farther than the chords, only its own distances count
+		m_maxDeviation = (3 == m_degree) ? 0 : m_chordalDeviation;
+	}
+
+	MStatus generatePlaneSections(MObjectArray &sectionCurves) {
+		MStatus status;
+
+		if (!computeSection())
+			return MS::kFailure;
+		simplifyContours();
+
+		for (unsigned int c = 0; c < m_section.numContours(); c++) {
+			status = appendContourCurve(c, sectionCurves);
 			CHECK_MSTATUS_AND_RETURN_IT(status);
-			for (unsigned int e = 0; e < connectedEdges.length(); e++)
-				if (m_intersectingEdges.end() != m_intersectingEdges.find(connectedEdges[e]))
-					return sortIntersections(connectedEdges[e], itPolygon, itEdge, itVertex, sortedEdges, isClosed);
 		}
 
-		isClosed = (onBoundary) ? false : true;
-
 		return MS::kSuccess;
 	}
 
-	MStatus clearConnected(MItMeshVertex &itVertex) {
+	MStatus appendContourCurve(unsigned int contour, MObjectArray &sectionCurves) {
 		MStatus status;
 
-		MIntArray connectedEdges;
-		status = itVertex.getConnectedEdges(connectedEdges);
+		const SVec3 *points = m_section.contourPoints(contour);
+		MPointArray sectionPoints(m_section.contourCount(contour));
+		for (unsigned int i = 0; i < sectionPoints.length(); i++)
+			sectionPoints[i] = SMeshAdapter::toPoint(points[i]);
+
+		MObject sectionCurve;
+		status = generateNurbsCurve(sectionPoints, (m_section.isClosed(contour)) ? MFnNurbsCurve::kClosed : MFnNurbsCurve::kOpen, sectionCurve, m_degree);
 		CHECK_MSTATUS_AND_RETURN_IT(status);
-		for (unsigned int e = 0; e < connectedEdges.length(); e++)
-			m_intersectingEdges.erase(connectedEdges[e]);
+
+		// A cubic can pass farther from the dropped points than the chords did
+		if (3 == m_degree && 0 < m_tolerance) {
+			MFnNurbsCurve fnCurve(sectionCurve, &status);
+			CHECK_MSTATUS_AND_RETURN_IT(status);
+			for (unsigned int i = m_sourceOffsets[contour]; i < m_sourceOffsets[contour + 1]; i++) {
+				double distance = fnCurve.distanceToPoint(SMeshAdapter::toPoint(m_sourcePoints[i]), MSpace::kObject, &status);
+				CHECK_MSTATUS_AND_RETURN_IT(status);
+				m_maxDeviation = std::max(m_maxDeviation, distance);
+			}
+		}
+		if(!sectionCurve.isNull())
+			sectionCurves.append(sectionCurve);
 
 		return MS::kSuccess;
 	}
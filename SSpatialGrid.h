@@ -0,0 +1,125 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+
+// Uniform grid over a point cloud for bounded-radius queries. Cells are hashed and stored in
+// flat sorted arrays, hash collisions only cost extra distance tests.
+class SSpatialGrid
+{
+public:
+	SSpatialGrid() {};
+	~SSpatialGrid() {};
+
+	// Points are given as xyz triplets
+	void build(const std::vector<double> &points, double cellSize) {
+		m_cellSize = (0 < cellSize) ? cellSize : 1.0;
+		m_points = points;
+
+		unsigned int numPoints = (unsigned int)(m_points.size() / 3);
+		std::vector <std::pair<unsigned long long, unsigned int>> keys(numPoints);
+		for (unsigned int i = 0; i < numPoints; i++) {
+			keys[i].first = cellKey(cellCoord(m_points[3 * i]), cellCoord(m_points[3 * i + 1]), cellCoord(m_points[3 * i + 2]));
+			keys[i].second = i;
+		}
+		std::sort(keys.begin(), keys.end());
+
+		m_cellKeys.clear();
+		m_cellOffsets.clear();
+		m_cellPoints.resize(numPoints);
+		for (unsigned int i = 0; i < numPoints; i++) {
+			if (i == 0 || keys[i].first != keys[i - 1].first) {
+				m_cellKeys.push_back(keys[i].first);
+				m_cellOffsets.push_back(i);
+			}
+			m_cellPoints[i] = keys[i].second;
+		}
+		m_cellOffsets.push_back(numPoints);
+	};
+
+	unsigned int numPoints() const {
+		return (unsigned int)(m_points.size() / 3);
+	};
+
+	const double *point(unsigned int index) const {
+		return m_points.data() + 3 * index;
+	};
+
+	// Calls visitor(index, squaredDistance) for every point within radius
+	template <typename Visitor>
+	void query(const double point[3], double radius, Visitor visitor) const {
+		if (m_cellKeys.size() == 0 || radius < 0)
+			return;
+
+		double squaredRadius = radius * radius;
+		long long
+			minCell[3],
+			maxCell[3];
+		for (unsigned int i = 0; i < 3; i++) {
+			minCell[i] = cellCoord(point[i] - radius);
+			maxCell[i] = cellCoord(point[i] + radius);
+		}
+
+		for (long long x = minCell[0]; x <= maxCell[0]; x++)
+			for (long long y = minCell[1]; y <= maxCell[1]; y++)
+				for (long long z = minCell[2]; z <= maxCell[2]; z++) {
+					auto cell = std::lower_bound(m_cellKeys.begin(), m_cellKeys.end(), cellKey(x, y, z));
+					if (cell == m_cellKeys.end() || *cell != cellKey(x, y, z))
+						continue;
+
+					unsigned int c = (unsigned int)(cell - m_cellKeys.begin());
+					for (unsigned int i = m_cellOffsets[c]; i < m_cellOffsets[c + 1]; i++) {
+						const double *other = this->point(m_cellPoints[i]);
+						double
+							dx = other[0] - point[0],
+							dy = other[1] - point[1],
+							dz = other[2] - point[2],
+							squaredDistance = dx * dx + dy * dy + dz * dz;
+						if (squaredDistance <= squaredRadius)
+							visitor(m_cellPoints[i], squaredDistance);
+					}
+				}
+	};
+
+	void query(const double point[3], double radius, std::vector<unsigned int> &indices) const {
+		indices.clear();
+		query(point, radius, [&indices](unsigned int index, double) {
+			indices.push_back(index);
+		});
+		std::sort(indices.begin(), indices.end());
+	};
+
+	// Closest point within radius, ties go to the lower index. Returns -1 when there is none.
+	int nearest(const double point[3], double radius) const {
+		int closest = -1;
+		double closestDistance = 0;
+		query(point, radius, [&](unsigned int index, double squaredDistance) {
+			if (closest < 0 || squaredDistance < closestDistance || (squaredDistance == closestDistance && (int)index < closest)) {
+				closest = index;
+				closestDistance = squaredDistance;
+			}
+		});
+		return closest;
+	};
+
+private:
+	double m_cellSize = 1.0;
+	std::vector <double> m_points;
+	std::vector <unsigned long long> m_cellKeys;
+	std::vector <unsigned int>
+		m_cellOffsets,
+		m_cellPoints;
+
+	long long cellCoord(double value) const {
+		return (long long)std::floor(value / m_cellSize);
+	};
+
+	static unsigned long long cellKey(long long x, long long y, long long z) {
+		unsigned long long key = (unsigned long long)x * 0x9E3779B97F4A7C15ULL;
+		key ^= (unsigned long long)y * 0xC2B2AE3D27D4EB4FULL + (key << 6) + (key >> 2);
+		key ^= (unsigned long long)z * 0x165667B19E3779F9ULL + (key << 6) + (key >> 2);
+		return key;
+	};
+};
\ No newline at end of file
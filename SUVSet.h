@@ -0,0 +1,62 @@
+#pragma once
+
+#include <maya\MString.h>
+#include <maya\MFloatArray.h>
+#include <maya\MIntArray.h>
+
+class SUVSet {
+public:
+	SUVSet(){};
+
+	SUVSet(const MString &name) {
+		this->name = name;
+	};
+
+	SUVSet(const SUVSet &uvSet) {
+		name = uvSet.name;
+		U = uvSet.U;
+		V = uvSet.V;
+		uvCounts = uvSet.uvCounts;
+		uvIndices = uvSet.uvIndices;
+	};
+
+	SUVSet& operator=(const SUVSet& uvSet) {
+		name = uvSet.name;
+		U = uvSet.U;
+		V = uvSet.V;
+		uvCounts = uvSet.uvCounts;
+		uvIndices = uvSet.uvIndices;
+
+		return *this;
+	}
+
+	~SUVSet() {}
+
+	virtual void addPolygon() {
+		unsigned int currentLength = U.length();
+		
+		U.append(0);
+		U.append(0);
+		U.append(1);
+		U.append(1);
+
+		V.append(0);
+		V.append(1);
+		V.append(1);
+		V.append(0);
+
+		for (unsigned int i = currentLength; i < currentLength + 4; i++)
+			uvIndices.append(i);
+
+		uvCounts.append(4);
+	}
+
+	MString
+		name;
+	MFloatArray
+		U,
+		V;
+	MIntArray
+		uvCounts,
+		uvIndices;
+};
\ No newline at end of file
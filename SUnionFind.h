@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+
+// Disjoint sets over element ids. The root of every set is its smallest element, which keeps
+// grouping results independent of the order in which elements are united.
+class SUnionFind
+{
+public:
+	SUnionFind(unsigned int size = 0) {
+		reset(size);
+	};
+	~SUnionFind() {};
+
+	void reset(unsigned int size) {
+		m_parent.resize(size);
+		for (unsigned int i = 0; i < size; i++)
+			m_parent[i] = i;
+	};
+
+	unsigned int size() const {
+		return (unsigned int)m_parent.size();
+	};
+
+	unsigned int find(unsigned int element) {
+		while (m_parent[element] != element) {
+			m_parent[element] = m_parent[m_parent[element]];
+			element = m_parent[element];
+		}
+		return element;
+	};
+
+	bool unite(unsigned int first, unsigned int second) {
+		first = find(first);
+		second = find(second);
+		if (first == second)
+			return false;
+
+		if (first < second)
+			m_parent[second] = first;
+		else
+			m_parent[first] = second;
+		return true;
+	};
+
+private:
+	std::vector <unsigned int> m_parent;
+};
\ No newline at end of file
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cmath>
+
+// Plain double precision 3D vector used by the Maya independent geometry code. Layout is three
+// consecutive doubles, arrays of SVec3 can be handed out as flat xyz buffers.
+struct SVec3
+{
+	double
+		x = 0,
+		y = 0,
+		z = 0;
+
+	SVec3() {};
+	SVec3(double x, double y, double z) : x(x), y(y), z(z) {};
+	explicit SVec3(const double values[3]) : x(values[0]), y(values[1]), z(values[2]) {};
+
+	SVec3 operator+(const SVec3 &other) const {
+		return SVec3(x + other.x, y + other.y, z + other.z);
+	};
+
+	SVec3 operator-(const SVec3 &other) const {
+		return SVec3(x - other.x, y - other.y, z - other.z);
+	};
+
+	SVec3 operator-() const {
+		return SVec3(-x, -y, -z);
+	};
+
+	SVec3 operator*(double scalar) const {
+		return SVec3(x * scalar, y * scalar, z * scalar);
+	};
+
+	SVec3 operator/(double scalar) const {
+		return SVec3(x / scalar, y / scalar, z / scalar);
+	};
+
+	SVec3 &operator+=(const SVec3 &other) {
+		x += other.x;
+		y += other.y;
+		z += other.z;
+		return *this;
+	};
+
+	SVec3 &operator-=(const SVec3 &other) {
+		x -= other.x;
+		y -= other.y;
+		z -= other.z;
+		return *this;
+	};
+
+	SVec3 &operator*=(double scalar) {
+		x *= scalar;
+		y *= scalar;
+		z *= scalar;
+		return *this;
+	};
+
+	bool operator==(const SVec3 &other) const {
+		return x == other.x && y == other.y && z == other.z;
+	};
+
+	bool operator!=(const SVec3 &other) const {
+		return !(*this == other);
+	};
+
+	double dot(const SVec3 &other) const {
+		return x * other.x + y * other.y + z * other.z;
+	};
+
+	SVec3 cross(const SVec3 &other) const {
+		return SVec3(y * other.z - z * other.y, z * other.x - x * other.z, x * other.y - y * other.x);
+	};
+
+	double squaredLength() const {
+		return dot(*this);
+	};
+
+	double length() const {
+		return std::sqrt(squaredLength());
+	};
+
+	// Zero vector stays zero, same as MVector::normal
+	SVec3 normal() const {
+		double len = length();
+		return (0 < len) ? *this / len : *this;
+	};
+
+	double angle(const SVec3 &other) const {
+		double len = length() * other.length();
+		if (len == 0)
+			return 0;
+		double cosine = dot(other) / len;
+		return std::acos((cosine < -1) ? -1 : (1 < cosine) ? 1 : cosine);
+	};
+
+	// Distance to the closest point of the segment between start and end
+	double distanceToSegment(const SVec3 &start, const SVec3 &end) const {
+		SVec3 direction = end - start;
+		double squaredLength = direction.squaredLength();
+		double parameter = (0 < squaredLength) ? (*this - start).dot(direction) / squaredLength : 0.0;
+		parameter = (parameter < 0) ? 0 : (1 < parameter) ? 1 : parameter;
+		return (*this - (start + direction * parameter)).length();
+	};
+
+	bool isEquivalent(const SVec3 &other, double tolerance) const {
+		return (*this - other).length() <= tolerance;
+	};
+
+	double &operator[](unsigned int i) {
+		return (&x)[i];
+	};
+
+	double operator[](unsigned int i) const {
+		return (&x)[i];
+	};
+};
+
+inline SVec3 operator*(double scalar, const SVec3 &vector) {
+	return vector * scalar;
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdio>
+
+// Heap statistics, fed by the replaced global operator new/delete of the benchmark
+struct SAllocationStats
+{
+	static std::atomic <unsigned long long> &count() {
+		static std::atomic <unsigned long long> value(0);
+		return value;
+	};
+
+	static std::atomic <unsigned long long> &bytes() {
+		static std::atomic <unsigned long long> value(0);
+		return value;
+	};
+
+	static std::atomic <long long> &liveBytes() {
+		static std::atomic <long long> value(0);
+		return value;
+	};
+
+	static std::atomic <long long> &peakBytes() {
+		static std::atomic <long long> value(0);
+		return value;
+	};
+
+	static void allocated(unsigned long long size) {
+		count()++;
+		bytes() += size;
+		long long live = (liveBytes() += (long long)size);
+		long long peak = peakBytes().load();
+		while (peak < live && !peakBytes().compare_exchange_weak(peak, live)) {}
+	};
+
+	static void released(unsigned long long size) {
+		liveBytes() -= (long long)size;
+	};
+};
+
+// One measured kernel run
+struct SBenchmarkRecord
+{
+	std::string
+		label,
+		shape,
+		selection,
+		kernel;
+	unsigned int
+		faces = 0,
+		vertices = 0,
+		edges = 0,
+		selectedEdges = 0,
+		threads = 0,
+		repetitions = 0;
+	double
+		minMs = 0,
+		medianMs = 0;
+	unsigned long long
+		allocations = 0,
+		allocatedBytes = 0;
+	long long
+		peakBytes = 0;
+	bool
+		isValid = true;
+};
+
+// Runs a kernel a number of times. setup() is not measured, kernel() is. Allocations and peak
+// heap growth are taken from the last repetition.
+class SBenchmark
+{
+public:
+	template <typename Setup, typename Kernel>
+	static void run(unsigned int repetitions, Setup setup, Kernel kernel, SBenchmarkRecord &record) {
+		std::vector <double> times;
+		record.repetitions = repetitions;
+		record.isValid = true;
+
+		for (unsigned int r = 0; r < repetitions; r++) {
+			setup();
+
+			unsigned long long
+				count = SAllocationStats::count().load(),
+				bytes = SAllocationStats::bytes().load();
+			long long live = SAllocationStats::liveBytes().load();
+			SAllocationStats::peakBytes().store(live);
+
+			auto begin = std::chrono::steady_clock::now();
+			bool result = kernel();
+			auto end = std::chrono::steady_clock::now();
+
+			times.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+			record.allocations = SAllocationStats::count().load() - count;
+			record.allocatedBytes = SAllocationStats::bytes().load() - bytes;
+			record.peakBytes = SAllocationStats::peakBytes().load() - live;
+			record.isValid = record.isValid && result;
+		}
+
+		std::sort(times.begin(), times.end());
+		record.minMs = (times.size() == 0) ? 0 : times.front();
+		record.medianMs = (times.size() == 0) ? 0 : times[times.size() / 2];
+	};
+};
+
+// Writes records as JSON lines or CSV
+class SBenchmarkReporter
+{
+public:
+	SBenchmarkReporter(FILE *file, bool isCsv) : m_file(file), m_isCsv(isCsv) {
+		if (m_isCsv)
+			fprintf(m_file, "label,shape,faces,vertices,edges,selection,selected_edges,kernel,threads,repetitions,min_ms,median_ms,allocations,allocated_bytes,peak_bytes,valid\n");
+	};
+
+	void write(const SBenchmarkRecord &record) {
+		if (m_isCsv)
+			fprintf(m_file, "%s,%s,%u,%u,%u,%s,%u,%s,%u,%u,%.4f,%.4f,%llu,%llu,%lld,%d\n",
+				record.label.c_str(), record.shape.c_str(), record.faces, record.vertices, record.edges,
+				record.selection.c_str(), record.selectedEdges, record.kernel.c_str(), record.threads, record.repetitions,
+				record.minMs, record.medianMs, record.allocations, record.allocatedBytes, record.peakBytes, record.isValid ? 1 : 0);
+		else
+			fprintf(m_file, "{\"label\":\"%s\",\"shape\":\"%s\",\"faces\":%u,\"vertices\":%u,\"edges\":%u,\"selection\":\"%s\",\"selected_edges\":%u,"
+				"\"kernel\":\"%s\",\"threads\":%u,\"repetitions\":%u,\"min_ms\":%.4f,\"median_ms\":%.4f,"
+				"\"allocations\":%llu,\"allocated_bytes\":%llu,\"peak_bytes\":%lld,\"valid\":%s}\n",
+				record.label.c_str(), record.shape.c_str(), record.faces, record.vertices, record.edges,
+				record.selection.c_str(), record.selectedEdges, record.kernel.c_str(), record.threads, record.repetitions,
+				record.minMs, record.medianMs, record.allocations, record.allocatedBytes, record.peakBytes, record.isValid ? "true" : "false");
+		fflush(m_file);
+	};
+
+private:
+	FILE *m_file;
+	bool m_isCsv;
+};
\ No newline at end of file
@@ -0,0 +1,336 @@
+#pragma once
+
+#include "SMeshGenerator.h"
+
+#include "../SMeshBuffer.h"
+#include "../SMeshTopology.h"
+#include "../SMeshSection.h"
+#include "../SFaceBVH.h"
+#include "../SEdgeGrid.h"
+#include "../SUnionFind.h"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+// Headless checks of the optimized kernels against straightforward reference implementations.
+// Every check returns false on the first mismatch.
+class SMeshCheck
+{
+public:
+	// Face corners around a vertex stay on one vertex across every edge that is not detached,
+	// the corners of every fan separated by detached edges get a vertex of their own
+	static bool detach(const SMeshBuffer &source, const SMeshTopology &topology, const std::vector <int> &edges) {
+		SMeshBuffer buffer = source;
+		buffer.setTopology(topology);
+		std::vector <unsigned int>
+			vtxMap(buffer.numVertices()),
+			vtxSplitValence(buffer.numVertices(), 0);
+		for (unsigned int v = 0; v < vtxMap.size(); v++)
+			vtxMap[v] = v;
+		if (!buffer.detachEdges(edges, vtxMap, vtxSplitValence))
+			return false;
+		if (buffer.indices.size() != source.indices.size() || vtxMap.size() != buffer.numVertices())
+			return false;
+
+		std::vector <bool> detached(topology.numEdges(), false);
+		for (auto &edge : edges)
+			detached[edge] = true;
+
+		SUnionFind corners(topology.numFaceVertices());
+		for (unsigned int e = 0; e < topology.numEdges(); e++) {
+			if (detached[e])
+				continue;
+			for (unsigned int end = 0; end < 2; end++) {
+				int vertex = topology.edgeVertex(e, end);
+				for (unsigned int f = 1; f < topology.numEdgeFaces(e); f++)
+					corners.unite(corner(topology, topology.edgeFaces(e)[0], vertex), corner(topology, topology.edgeFaces(e)[f], vertex));
+			}
+		}
+
+		// Corner groups and result vertices have to match one to one
+		std::vector <int>
+			groupVertices(topology.numFaceVertices(), -1),
+			vertexGroups(buffer.numVertices(), -1);
+		for (unsigned int c = 0; c < topology.numFaceVertices(); c++) {
+			int
+				group = (int)corners.find(c),
+				vertex = buffer.indices[c];
+			if (vtxMap[vertex] != (unsigned int)source.indices[c])
+				return false;
+			if (groupVertices[group] < 0 && vertexGroups[vertex] < 0) {
+				groupVertices[group] = vertex;
+				vertexGroups[vertex] = group;
+			}
+			if (groupVertices[group] != vertex || vertexGroups[vertex] != group)
+				return false;
+		}
+
+		for (unsigned int v = source.numVertices(); v < buffer.numVertices(); v++)
+			if (vertexGroups[v] < 0 || !(buffer.points[v] == source.points[vtxMap[v]]))
+				return false;
+
+		return true;
+	};
+
+	// Union-find grouping against a flood fill over the same neighbours
+	static bool grouping(const SMeshTopology &topology, const std::vector <int> &faces, const std::vector <int> &vertices) {
+		std::vector <int> offsets, elements, referenceOffsets, referenceElements;
+
+		if (!topology.groupConnectedFaces(faces, offsets, elements))
+			return false;
+		floodFill(topology.numFaces(), faces, [&](unsigned int face, std::vector <int> &connected) {
+			for (unsigned int e = 0; e < topology.faceCount(face); e++) {
+				int edge = topology.faceEdges(face)[e];
+				connected.insert(connected.end(), topology.edgeFaces(edge), topology.edgeFaces(edge) + topology.numEdgeFaces(edge));
+			}
+		}, referenceOffsets, referenceElements);
+		if (offsets != referenceOffsets || elements != referenceElements)
+			return false;
+
+		if (!topology.groupConnectedVertices(vertices, offsets, elements))
+			return false;
+		floodFill(topology.numVertices(), vertices, [&](unsigned int vertex, std::vector <int> &connected) {
+			for (unsigned int e = 0; e < topology.numConnectedEdges(vertex); e++)
+				connected.push_back(topology.oppositeVertex(vertex, topology.connectedEdges(vertex)[e]));
+		}, referenceOffsets, referenceElements);
+		return offsets == referenceOffsets && elements == referenceElements;
+	};
+
+	// Every listed edge lies on exactly one loop, every loop is a chain of oriented edges and no
+	// open loop could be continued straight across its end vertices by another listed edge
+	static bool loops(const SMeshTopology &topology, const std::vector <int> &edges) {
+		std::vector <int> loopOffsets, loopEdges;
+		std::vector <bool> loopFlipped;
+		if (!topology.findEdgeLoops(edges, loopOffsets, loopEdges, loopFlipped))
+			return false;
+
+		std::vector <int> listed(edges), found(loopEdges);
+		std::sort(listed.begin(), listed.end());
+		listed.erase(std::unique(listed.begin(), listed.end()), listed.end());
+		std::sort(found.begin(), found.end());
+		if (listed != found || loopFlipped.size() != loopEdges.size())
+			return false;
+
+		std::vector <bool> isListed(topology.numEdges(), false);
+		for (auto &edge : listed)
+			isListed[edge] = true;
+
+		for (unsigned int l = 0; l + 1 < loopOffsets.size(); l++) {
+			int
+				first = loopOffsets[l],
+				last = loopOffsets[l + 1] - 1;
+			for (int i = first + 1; i <= last; i++)
+				if (topology.edgeVertex(loopEdges[i - 1], loopFlipped[i - 1] ? 0 : 1) != topology.edgeVertex(loopEdges[i], loopFlipped[i] ? 1 : 0))
+					return false;
+
+			int
+				start = topology.edgeVertex(loopEdges[first], loopFlipped[first] ? 1 : 0),
+				end = topology.edgeVertex(loopEdges[last], loopFlipped[last] ? 0 : 1);
+			if (start == end)
+				continue;
+
+			int
+				before = straightEdge(topology, start, loopEdges[first]),
+				after = straightEdge(topology, end, loopEdges[last]);
+			if ((0 <= before && isListed[before]) || (0 <= after && isListed[after]))
+				return false;
+		}
+
+		return true;
+	};
+
+	// Two parallel seams one row apart on a grid of side quads, both rows lie inside the tolerance
+	// of every source edge. Source edges span two target edges and sit a tenth off their row.
+	static bool seams(unsigned int side) {
+		side = std::max(4u, side & ~1u);
+		SMeshBuffer buffer;
+		std::vector <int> seamPairs;
+		SMeshGenerator::grid(side, side, side, buffer, seamPairs);
+		const SMeshTopology &topology = buffer.topology();
+
+		SEdgeGrid grid;
+		grid.build(topology, buffer.points);
+
+		const unsigned int rows[2] = { side / 2, side / 2 + 1 };
+		const double shifts[2] = { 0.1, -0.1 };
+		std::vector <SVec3> starts, ends;
+		std::vector <std::vector<unsigned int>> expected;
+		for (unsigned int r = 0; r < 2; r++)
+			for (unsigned int i = 0; i + 2 <= side; i += 2) {
+				starts.push_back(SVec3(i, rows[r] + shifts[r], 0));
+				ends.push_back(SVec3(i + 2, rows[r] + shifts[r], 0));
+
+				unsigned int vertex = rows[r] * (side + 1) + i;
+				expected.push_back(std::vector<unsigned int>());
+				for (unsigned int k = 0; k < 2; k++)
+					expected.back().push_back(topology.findEdge(vertex + k, vertex + k + 1));
+			}
+
+		std::vector <std::vector<unsigned int>> chains;
+		grid.matchSegments(topology, starts, ends, 1.5, chains);
+		return chains == expected;
+	};
+
+	static bool marching(const SMeshTopology &topology, const std::vector <SVec3> &points, const SVec3 &origin, const SVec3 &normal) {
+		SMeshSection reference(origin, normal), section(origin, normal);
+		if (!reference.compute(topology, points) || !section.computeMarching(topology, points))
+			return false;
+		return sameSections(reference, section);
+	};
+
+	static bool culled(const SMeshTopology &topology, const std::vector <SVec3> &points, const SFaceBVH &tree, const SVec3 &origin, const SVec3 &normal) {
+		SMeshSection reference(origin, normal), section(origin, normal);
+		if (!reference.compute(topology, points) || !section.compute(topology, points, tree))
+			return false;
+		return sameSections(reference, section);
+	};
+
+	// Slices against one section per plane, contours of a plane keep the single plane order
+	static bool slices(const SMeshTopology &topology, const std::vector <SVec3> &points, const SVec3 &origin, const SVec3 &direction, const std::vector <double> &offsets) {
+		SMeshSection section;
+		if (!section.computeSlices(topology, points, origin, direction, offsets))
+			return false;
+
+		unsigned int contour = 0;
+		for (unsigned int p = 0; p < offsets.size(); p++) {
+			SMeshSection reference(origin + direction.normal() * offsets[p], direction.normal());
+			if (!reference.compute(topology, points))
+				return false;
+
+			std::vector <unsigned int> planeContours;
+			for (unsigned int c = 0; c < section.numContours(); c++)
+				if (section.contourPlane(c) == p)
+					planeContours.push_back(c);
+			if (planeContours.size() != reference.numContours())
+				return false;
+
+			for (unsigned int c = 0; c < planeContours.size(); c++)
+				if (!sameContours(reference, c, section, planeContours[c]))
+					return false;
+			contour += (unsigned int)planeContours.size();
+		}
+		return contour == section.numContours();
+	};
+
+	// Every dropped point lies within the reported deviation of the simplified contour, which
+	// stays within tolerance and keeps the contour ends
+	static bool simplify(const SMeshTopology &topology, const std::vector <SVec3> &points, const SVec3 &origin, const SVec3 &normal, double tolerance) {
+		SMeshSection section(origin, normal);
+		if (!section.compute(topology, points))
+			return false;
+
+		std::vector <unsigned int> offsets;
+		std::vector <SVec3> original;
+		std::vector <bool> closed;
+		std::vector <int> edges;
+		std::vector <double> parameters;
+		section.getPolylines(offsets, original, closed, edges, parameters);
+
+		double deviation = section.simplify(tolerance);
+		if (tolerance < deviation || section.numContours() + 1 != offsets.size())
+			return false;
+
+		for (unsigned int c = 0; c < section.numContours(); c++) {
+			const SVec3 *simplified = section.contourPoints(c);
+			unsigned int count = section.contourCount(c);
+			if (count < 2 || section.isClosed(c) != closed[c])
+				return false;
+			if (!(simplified[0] == original[offsets[c]]) || !(simplified[count - 1] == original[offsets[c + 1] - 1]))
+				return false;
+
+			for (unsigned int i = offsets[c]; i < offsets[c + 1]; i++) {
+				double distance = original[i].distanceToSegment(simplified[0], simplified[1]);
+				for (unsigned int j = 1; j + 1 < count; j++)
+					distance = std::min(distance, original[i].distanceToSegment(simplified[j], simplified[j + 1]));
+				if (deviation + 1e-12 < distance)
+					return false;
+			}
+		}
+		return true;
+	};
+
+private:
+	// Edge running straight on from edge through vertex, -1 at poles, mesh corners and where an
+	// edge meets the boundary
+	static int straightEdge(const SMeshTopology &topology, unsigned int vertex, int edge) {
+		int
+			numEdges = topology.numConnectedEdges(vertex),
+			index = topology.relativeEdgeIndex(vertex, edge);
+		if (topology.onBoundary(vertex)) {
+			if (numEdges == 2 || (index != 0 && index != numEdges - 1))
+				return -1;
+			return topology.connectedEdges(vertex)[(index == 0) ? numEdges - 1 : 0];
+		}
+		return (numEdges == 4) ? topology.connectedEdges(vertex)[(index + 2) % 4] : -1;
+	};
+
+	static unsigned int corner(const SMeshTopology &topology, unsigned int face, int vertex) {
+		unsigned int i = 0;
+		while (i + 1 < topology.faceCount(face) && topology.faceVertices(face)[i] != vertex)
+			i++;
+		return topology.faceOffset(face) + i;
+	};
+
+	// Groups ordered by their smallest element, elements ascending within a group
+	template <typename Neighbors>
+	static void floodFill(unsigned int numElements, const std::vector <int> &elements, Neighbors neighbors, std::vector <int> &groupOffsets, std::vector <int> &groupElements) {
+		groupOffsets.assign(1, 0);
+		groupElements.clear();
+
+		std::vector <bool> selected(numElements, false), visited(numElements, false);
+		for (auto &element : elements)
+			selected[element] = true;
+
+		std::vector <int> stack, connected;
+		for (unsigned int element = 0; element < numElements; element++) {
+			if (!selected[element] || visited[element])
+				continue;
+
+			unsigned int first = (unsigned int)groupElements.size();
+			visited[element] = true;
+			stack.assign(1, element);
+			while (0 < stack.size()) {
+				int current = stack.back();
+				stack.pop_back();
+				groupElements.push_back(current);
+
+				connected.clear();
+				neighbors(current, connected);
+				for (auto &neighbor : connected)
+					if (selected[neighbor] && !visited[neighbor]) {
+						visited[neighbor] = true;
+						stack.push_back(neighbor);
+					}
+			}
+			std::sort(groupElements.begin() + first, groupElements.end());
+			groupOffsets.push_back((int)groupElements.size());
+		}
+	};
+
+	// Edges, parameters and closure match exactly, points up to rounding of the plane distance
+	static bool sameContours(const SMeshSection &a, unsigned int contourA, const SMeshSection &b, unsigned int contourB) {
+		unsigned int count = a.contourCount(contourA);
+		if (count != b.contourCount(contourB) || a.isClosed(contourA) != b.isClosed(contourB))
+			return false;
+
+		for (unsigned int i = 0; i < count; i++) {
+			if (a.contourEdges(contourA)[i] != b.contourEdges(contourB)[i])
+				return false;
+			if (1e-9 < std::fabs(a.contourParameters(contourA)[i] - b.contourParameters(contourB)[i]))
+				return false;
+			if (!a.contourPoints(contourA)[i].isEquivalent(b.contourPoints(contourB)[i], 1e-9))
+				return false;
+		}
+		return true;
+	};
+
+	static bool sameSections(const SMeshSection &a, const SMeshSection &b) {
+		if (a.numContours() != b.numContours())
+			return false;
+		for (unsigned int c = 0; c < a.numContours(); c++)
+			if (!sameContours(a, c, b, c))
+				return false;
+		return true;
+	};
+};
\ No newline at end of file
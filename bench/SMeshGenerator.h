@@ -0,0 +1,130 @@
+#pragma once
+
+#include "../SMeshBuffer.h"
+
+#include <vector>
+#include <random>
+#include <cmath>
+
+// Synthetic quad meshes for benchmarking. Every generator also lists vertex pairs of structured
+// seams, full edge rings every stride rows that run across the mesh.
+class SMeshGenerator
+{
+public:
+	static constexpr double kPi = 3.14159265358979323846;
+
+	// Open grid of nx by ny quads in the XY plane
+	static void grid(unsigned int nx, unsigned int ny, unsigned int stride, SMeshBuffer &buffer, std::vector <int> &seamPairs) {
+		buffer.clear();
+		seamPairs.clear();
+
+		for (unsigned int j = 0; j <= ny; j++)
+			for (unsigned int i = 0; i <= nx; i++)
+				buffer.points.push_back(SVec3(i, j, 0));
+
+		for (unsigned int j = 0; j < ny; j++)
+			for (unsigned int i = 0; i < nx; i++)
+				addQuad(buffer, j * (nx + 1) + i, j * (nx + 1) + i + 1, (j + 1) * (nx + 1) + i + 1, (j + 1) * (nx + 1) + i);
+
+		for (unsigned int j = stride; j < ny; j += stride)
+			for (unsigned int i = 0; i < nx; i++)
+				addPair(seamPairs, j * (nx + 1) + i, j * (nx + 1) + i + 1);
+
+		finish(buffer);
+	};
+
+	// Open tube along Z with segments around and rings along
+	static void cylinder(unsigned int segments, unsigned int rings, unsigned int stride, SMeshBuffer &buffer, std::vector <int> &seamPairs) {
+		buffer.clear();
+		seamPairs.clear();
+
+		for (unsigned int j = 0; j <= rings; j++)
+			for (unsigned int i = 0; i < segments; i++) {
+				double angle = 2 * kPi * i / segments;
+				buffer.points.push_back(SVec3(std::cos(angle), std::sin(angle), (double)j / segments * 2 * kPi));
+			}
+
+		for (unsigned int j = 0; j < rings; j++)
+			for (unsigned int i = 0; i < segments; i++) {
+				unsigned int next = (i + 1) % segments;
+				addQuad(buffer, j * segments + i, j * segments + next, (j + 1) * segments + next, (j + 1) * segments + i);
+			}
+
+		for (unsigned int j = stride; j < rings; j += stride)
+			for (unsigned int i = 0; i < segments; i++)
+				addPair(seamPairs, j * segments + i, j * segments + (i + 1) % segments);
+
+		finish(buffer);
+	};
+
+	// Closed torus, no boundary
+	static void torus(unsigned int segments, unsigned int rings, unsigned int stride, SMeshBuffer &buffer, std::vector <int> &seamPairs) {
+		buffer.clear();
+		seamPairs.clear();
+
+		const double
+			majorRadius = 3,
+			minorRadius = 1;
+		for (unsigned int j = 0; j < rings; j++)
+			for (unsigned int i = 0; i < segments; i++) {
+				double
+					u = 2 * kPi * j / rings,
+					v = 2 * kPi * i / segments,
+					radius = majorRadius + minorRadius * std::cos(v);
+				buffer.points.push_back(SVec3(radius * std::cos(u), radius * std::sin(u), minorRadius * std::sin(v)));
+			}
+
+		for (unsigned int j = 0; j < rings; j++)
+			for (unsigned int i = 0; i < segments; i++) {
+				unsigned int
+					nextI = (i + 1) % segments,
+					nextJ = (j + 1) % rings;
+				addQuad(buffer, j * segments + i, j * segments + nextI, nextJ * segments + nextI, nextJ * segments + i);
+			}
+
+		for (unsigned int j = 0; j < rings; j += stride)
+			for (unsigned int i = 0; i < segments; i++)
+				addPair(seamPairs, j * segments + i, j * segments + (i + 1) % segments);
+
+		finish(buffer);
+	};
+
+	// Every edge is picked with the given probability, the seed keeps runs comparable
+	static void randomEdges(unsigned int numEdges, double probability, unsigned int seed, std::vector <int> &edges) {
+		edges.clear();
+		std::mt19937 generator(seed);
+		std::uniform_real_distribution <double> distribution(0.0, 1.0);
+		for (unsigned int e = 0; e < numEdges; e++)
+			if (distribution(generator) < probability)
+				edges.push_back(e);
+	};
+
+	static void pairsToEdges(const SMeshTopology &topology, const std::vector <int> &pairs, std::vector <int> &edges) {
+		edges.clear();
+		for (unsigned int i = 0; i + 1 < pairs.size(); i += 2) {
+			int edge = topology.findEdge(pairs[i], pairs[i + 1]);
+			if (0 <= edge)
+				edges.push_back(edge);
+		}
+	};
+
+private:
+	static void addQuad(SMeshBuffer &buffer, unsigned int a, unsigned int b, unsigned int c, unsigned int d) {
+		buffer.counts.push_back(4);
+		buffer.indices.push_back(a);
+		buffer.indices.push_back(b);
+		buffer.indices.push_back(c);
+		buffer.indices.push_back(d);
+	};
+
+	static void addPair(std::vector <int> &pairs, unsigned int a, unsigned int b) {
+		pairs.push_back(a);
+		pairs.push_back(b);
+	};
+
+	// Shared normals are needed by the offset and extrude kernels
+	static void finish(SMeshBuffer &buffer) {
+		buffer.computeVertexNormals(buffer.normals);
+		buffer.invalidateTopology();
+	};
+};
\ No newline at end of file
@@ -0,0 +1,455 @@
+// Benchmarks for the Maya independent mesh, loop and section kernels.
+//
+//   smesh_benchmark [--sizes 1000,10000,...] [--shapes grid,cylinder,torus]
+//                   [--kernels topology,loops,detach,offset,section,marching,culled,slices]
+//                   [--repetitions 3] [--random 0.05] [--stride 16]
+//                   [--format json|csv] [--output file] [--label name]
+//   smesh_benchmark --check [--sizes 1000,20000] [--shapes ...] [--stride 16] [--random 0.05]
+//   smesh_benchmark --help
+//
+// Every kernel run writes one record with min and median time, heap allocations, allocated
+// bytes and peak heap growth. JSON lines are the default so results can be appended per release.
+// The check mode compares the optimized kernels with reference paths on the generated meshes
+// instead, it prints one line per check and exits with 1 when any of them fails.
+
+#include "SBenchmark.h"
+#include "SMeshGenerator.h"
+#include "SMeshCheck.h"
+
+#include "../SMeshTopology.h"
+#include "../SMeshBuffer.h"
+#include "../SMeshSection.h"
+#include "../SParallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <sstream>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Heap tracking //////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Every block carries its size in front, aligned for any type
+static const size_t kHeader = 16;
+
+static void *trackedAlloc(size_t size) {
+	void *block = std::malloc(size + kHeader);
+	if (block == NULL)
+		throw std::bad_alloc();
+	*static_cast<size_t*>(block) = size;
+	SAllocationStats::allocated(size);
+	return static_cast<char*>(block) + kHeader;
+}
+
+static void trackedFree(void *pointer) {
+	if (pointer == NULL)
+		return;
+	void *block = static_cast<char*>(pointer) - kHeader;
+	SAllocationStats::released(*static_cast<size_t*>(block));
+	std::free(block);
+}
+
+void *operator new(size_t size) { return trackedAlloc(size); }
+void *operator new[](size_t size) { return trackedAlloc(size); }
+void *operator new(size_t size, const std::nothrow_t&) noexcept { try { return trackedAlloc(size); } catch (...) { return NULL; } }
+void *operator new[](size_t size, const std::nothrow_t&) noexcept { try { return trackedAlloc(size); } catch (...) { return NULL; } }
+void operator delete(void *pointer) noexcept { trackedFree(pointer); }
+void operator delete[](void *pointer) noexcept { trackedFree(pointer); }
+void operator delete(void *pointer, size_t) noexcept { trackedFree(pointer); }
+void operator delete[](void *pointer, size_t) noexcept { trackedFree(pointer); }
+void operator delete(void *pointer, const std::nothrow_t&) noexcept { trackedFree(pointer); }
+void operator delete[](void *pointer, const std::nothrow_t&) noexcept { trackedFree(pointer); }
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Options ////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct SBenchmarkOptions
+{
+	std::vector <unsigned int> sizes = { 1000, 10000, 100000, 1000000, 5000000 };
+	std::vector <std::string> shapes = { "grid", "cylinder", "torus" };
+	std::vector <std::string> kernels = { "topology", "loops", "detach", "offset", "section", "marching", "culled", "slices" };
+	unsigned int
+		repetitions = 3,
+		stride = 16;
+	double randomProbability = 0.05;
+	bool
+		isCsv = false,
+		isCheck = false,
+		isHelp = false,
+		hasSizes = false;
+	std::string
+		output,
+		label = "local";
+};
+
+static std::vector <std::string> split(const std::string &text) {
+	std::vector <std::string> parts;
+	std::stringstream stream(text);
+	std::string part;
+	while (std::getline(stream, part, ','))
+		if (0 < part.size())
+			parts.push_back(part);
+	return parts;
+}
+
+static bool contains(const std::vector <std::string> &list, const std::string &value) {
+	return std::find(list.begin(), list.end(), value) != list.end();
+}
+
+static void printUsage(FILE *file) {
+	fprintf(file,
+		"usage: smesh_benchmark [--sizes 1000,10000,...] [--shapes grid,cylinder,torus]\n"
+		"                       [--kernels topology,loops,detach,offset,section,marching,culled,slices]\n"
+		"                       [--repetitions 3] [--random 0.05] [--stride 16]\n"
+		"                       [--format json|csv] [--output file] [--label name]\n"
+		"       smesh_benchmark --check [--sizes 1000,20000] [--shapes ...] [--stride 16] [--random 0.05]\n"
+		"       smesh_benchmark --help\n");
+}
+
+static bool parseOptions(int argc, char **argv, SBenchmarkOptions &options) {
+	for (int i = 1; i < argc; i++) {
+		std::string argument = argv[i];
+
+		// Flags without a value
+		if (argument == "--help" || argument == "-h") {
+			options.isHelp = true;
+			continue;
+		}
+		if (argument == "--check") {
+			options.isCheck = true;
+			continue;
+		}
+
+		if (i + 1 >= argc) {
+			fprintf(stderr, "missing value for %s\n", argument.c_str());
+			return false;
+		}
+		std::string value = argv[++i];
+
+		if (argument == "--sizes") {
+			options.hasSizes = true;
+			options.sizes.clear();
+			for (auto &size : split(value))
+				options.sizes.push_back((unsigned int)std::strtoul(size.c_str(), NULL, 10));
+		}
+		else if (argument == "--shapes")
+			options.shapes = split(value);
+		else if (argument == "--kernels")
+			options.kernels = split(value);
+		else if (argument == "--repetitions")
+			options.repetitions = std::max(1u, (unsigned int)std::strtoul(value.c_str(), NULL, 10));
+		else if (argument == "--stride")
+			options.stride = std::max(1u, (unsigned int)std::strtoul(value.c_str(), NULL, 10));
+		else if (argument == "--random")
+			options.randomProbability = std::strtod(value.c_str(), NULL);
+		else if (argument == "--format")
+			options.isCsv = (value == "csv");
+		else if (argument == "--output")
+			options.output = value;
+		else if (argument == "--label")
+			options.label = value;
+		else {
+			fprintf(stderr, "unknown option %s\n", argument.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Kernels ////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void generate(const std::string &shape, unsigned int faces, unsigned int stride, SMeshBuffer &buffer, std::vector <int> &seamPairs) {
+	unsigned int side = std::max(2u, (unsigned int)std::sqrt((double)faces));
+	unsigned int other = std::max(2u, faces / side);
+
+	if (shape == "cylinder")
+		SMeshGenerator::cylinder(side, other, stride, buffer, seamPairs);
+	else if (shape == "torus")
+		SMeshGenerator::torus(side, other, stride, buffer, seamPairs);
+	else
+		SMeshGenerator::grid(side, other, stride, buffer, seamPairs);
+}
+
+static void runKernels(const SBenchmarkOptions &options, const std::string &shape, unsigned int faces, SBenchmarkReporter &reporter) {
+	SMeshBuffer source;
+	std::vector <int> seamPairs;
+	generate(shape, faces, options.stride, source, seamPairs);
+
+	const SMeshTopology &topology = source.topology();
+
+	std::vector <int> structured, random, boundary;
+	SMeshGenerator::pairsToEdges(topology, seamPairs, structured);
+	SMeshGenerator::randomEdges(topology.numEdges(), options.randomProbability, 1, random);
+	for (unsigned int e = 0; e < topology.numEdges(); e++)
+		if (topology.edgeOnBoundary(e))
+			boundary.push_back(e);
+
+	SBenchmarkRecord base;
+	base.label = options.label;
+	base.shape = shape;
+	base.faces = topology.numFaces();
+	base.vertices = topology.numVertices();
+	base.edges = topology.numEdges();
+	base.threads = SParallel::numThreads();
+
+	auto record = [&](const std::string &kernel, const std::string &selection, unsigned int selectedEdges) {
+		SBenchmarkRecord result = base;
+		result.kernel = kernel;
+		result.selection = selection;
+		result.selectedEdges = selectedEdges;
+		return result;
+	};
+
+	const std::vector <std::pair<std::string, const std::vector <int>*>> selections = {
+		std::make_pair(std::string("structured"), &structured),
+		std::make_pair(std::string("random"), &random)
+	};
+
+	if (contains(options.kernels, "topology")) {
+		SMeshTopology built;
+		SBenchmarkRecord result = record("topology", "none", 0);
+		SBenchmark::run(options.repetitions, [&]() { built.clear(); }, [&]() {
+			return built.build(source.numVertices(), source.counts, source.indices);
+		}, result);
+		reporter.write(result);
+	}
+
+	if (contains(options.kernels, "loops")) {
+		for (auto &selection : selections) {
+			std::vector <int> loopOffsets, loopEdges;
+			std::vector <bool> loopFlipped;
+			SBenchmarkRecord result = record("loops", selection.first, (unsigned int)selection.second->size());
+			SBenchmark::run(options.repetitions, [&]() {}, [&]() {
+				return topology.findEdgeLoops(*selection.second, loopOffsets, loopEdges, loopFlipped);
+			}, result);
+			reporter.write(result);
+		}
+	}
+
+	if (contains(options.kernels, "detach")) {
+		for (auto &selection : selections) {
+			SMeshBuffer buffer;
+			std::vector <unsigned int> vtxMap, vtxSplitValence;
+			SBenchmarkRecord result = record("detach", selection.first, (unsigned int)selection.second->size());
+			SBenchmark::run(options.repetitions, [&]() {
+				buffer = source;
+				buffer.setTopology(topology);
+				vtxMap.resize(buffer.numVertices());
+				for (unsigned int v = 0; v < vtxMap.size(); v++)
+					vtxMap[v] = v;
+				vtxSplitValence.assign(buffer.numVertices(), 0);
+			}, [&]() {
+				return buffer.detachEdges(*selection.second, vtxMap, vtxSplitValence);
+			}, result);
+			reporter.write(result);
+		}
+	}
+
+	// Offsets every boundary loop into the same buffer, the way offsetEdgeloops does
+	if (contains(options.kernels, "offset") && 0 < boundary.size()) {
+		std::vector <int> loopOffsets, loopEdges;
+		std::vector <bool> loopFlipped;
+		topology.findEdgeLoops(boundary, loopOffsets, loopEdges, loopFlipped);
+
+		std::vector <std::vector<unsigned int>> loops;
+		for (unsigned int l = 0; l + 1 < loopOffsets.size(); l++)
+			loops.push_back(std::vector<unsigned int>(loopEdges.begin() + loopOffsets[l], loopEdges.begin() + loopOffsets[l + 1]));
+
+		SMeshBuffer buffer;
+		SBenchmarkRecord result = record("offset", "boundary", (unsigned int)boundary.size());
+		SBenchmark::run(options.repetitions, [&]() {
+			buffer = source;
+			buffer.setTopology(topology);
+		}, [&]() {
+			std::vector <SLoopOffset> offsets;
+			unsigned int begin = 0;
+			while (begin < loops.size()) {
+				unsigned int end = buffer.independentLoops(loops, begin);
+				if (!buffer.offsetEdgeloops(loops, begin, end, 0.1f, true, offsets))
+					return false;
+				begin = end;
+			}
+			return true;
+		}, result);
+		reporter.write(result);
+	}
+
+	// Plane through the middle of the bounding box, nudged off the vertex lattice
+	SVec3 minimum = source.points[0], maximum = source.points[0];
+	for (auto &point : source.points)
+		for (unsigned int i = 0; i < 3; i++) {
+			minimum[i] = std::min(minimum[i], point[i]);
+			maximum[i] = std::max(maximum[i], point[i]);
+		}
+	SVec3 center = (minimum + maximum) * 0.5 + SVec3(1e-4, 0, 0);
+
+	if (contains(options.kernels, "section")) {
+		SMeshSection section(center, SVec3(1, 0, 0));
+		SBenchmarkRecord result = record("section", "plane", 0);
+		SBenchmark::run(options.repetitions, [&]() {}, [&]() {
+			return section.compute(topology, source.points);
+		}, result);
+		reporter.write(result);
+	}
+
+	if (contains(options.kernels, "marching")) {
+		SMeshSection section(center, SVec3(1, 0, 0));
+		SBenchmarkRecord result = record("marching", "plane", 0);
+		SBenchmark::run(options.repetitions, [&]() {}, [&]() {
+			return section.computeMarching(topology, source.points);
+		}, result);
+		reporter.write(result);
+	}
+
+	// Face hierarchy is built once, only the section is timed
+	if (contains(options.kernels, "culled")) {
+		SFaceBVH tree;
+		tree.build(topology, source.points);
+
+		SMeshSection section(center, SVec3(1, 0, 0));
+		SBenchmarkRecord result = record("culled", "plane", 0);
+		SBenchmark::run(options.repetitions, [&]() {}, [&]() {
+			return section.compute(topology, source.points, tree);
+		}, result);
+		reporter.write(result);
+	}
+
+	// 200 evenly spaced planes across the bounding box
+	if (contains(options.kernels, "slices")) {
+		const unsigned int numPlanes = 200;
+		std::vector <double> offsets(numPlanes);
+		for (unsigned int p = 0; p < numPlanes; p++)
+			offsets[p] = minimum.x - center.x + (maximum.x - minimum.x) * (p + 0.5) / numPlanes;
+
+		SMeshSection section;
+		SBenchmarkRecord result = record("slices", "planes", 0);
+		SBenchmark::run(options.repetitions, [&]() {}, [&]() {
+			return section.computeSlices(topology, source.points, center, SVec3(1, 0, 0), offsets);
+		}, result);
+		reporter.write(result);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Checks /////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Returns the number of failed checks
+static unsigned int runChecks(const SBenchmarkOptions &options, const std::string &shape, unsigned int faces) {
+	SMeshBuffer source;
+	std::vector <int> seamPairs;
+	generate(shape, faces, options.stride, source, seamPairs);
+
+	const SMeshTopology &topology = source.topology();
+
+	std::vector <int> structured, random, dense, boundary, randomFaces, randomVertices;
+	SMeshGenerator::pairsToEdges(topology, seamPairs, structured);
+	SMeshGenerator::randomEdges(topology.numEdges(), options.randomProbability, 1, random);
+	SMeshGenerator::randomEdges(topology.numEdges(), 0.5, 4, dense);
+	SMeshGenerator::randomEdges(topology.numFaces(), 0.5, 2, randomFaces);
+	SMeshGenerator::randomEdges(topology.numVertices(), 0.5, 3, randomVertices);
+	for (unsigned int e = 0; e < topology.numEdges(); e++)
+		if (topology.edgeOnBoundary(e))
+			boundary.push_back(e);
+
+	SVec3 minimum = source.points[0], maximum = source.points[0];
+	for (auto &point : source.points)
+		for (unsigned int i = 0; i < 3; i++) {
+			minimum[i] = std::min(minimum[i], point[i]);
+			maximum[i] = std::max(maximum[i], point[i]);
+		}
+	SVec3 center = (minimum + maximum) * 0.5;
+	double size = (maximum - minimum).length();
+
+	// Axis plane nudged off the lattice, an oblique one and one through a vertex
+	const std::vector <std::pair<SVec3, SVec3>> planes = {
+		std::make_pair(center + SVec3(1e-4, 0, 0), SVec3(1, 0, 0)),
+		std::make_pair(center, SVec3(1, 1, 0.3)),
+		std::make_pair(source.points[source.numVertices() / 2], SVec3(0, 1, 0))
+	};
+
+	SFaceBVH tree;
+	tree.build(topology, source.points);
+
+	std::vector <double> offsets(25);
+	for (unsigned int p = 0; p < offsets.size(); p++)
+		offsets[p] = size * ((p + 0.5) / offsets.size() - 0.5);
+
+	std::vector <std::pair<std::string, bool>> results;
+	results.push_back(std::make_pair(std::string("detach structured"), SMeshCheck::detach(source, topology, structured)));
+	results.push_back(std::make_pair(std::string("detach random"), SMeshCheck::detach(source, topology, random)));
+	results.push_back(std::make_pair(std::string("grouping"), SMeshCheck::grouping(topology, randomFaces, randomVertices)));
+	results.push_back(std::make_pair(std::string("loops structured"), SMeshCheck::loops(topology, structured)));
+	results.push_back(std::make_pair(std::string("loops dense"), SMeshCheck::loops(topology, dense)));
+	results.push_back(std::make_pair(std::string("loops boundary"), SMeshCheck::loops(topology, boundary)));
+	if (shape == "grid")
+		results.push_back(std::make_pair(std::string("seam matching"), SMeshCheck::seams((unsigned int)std::sqrt((double)faces))));
+	for (unsigned int p = 0; p < planes.size(); p++) {
+		std::string plane = " plane " + std::to_string(p);
+		results.push_back(std::make_pair("marching" + plane, SMeshCheck::marching(topology, source.points, planes[p].first, planes[p].second)));
+		results.push_back(std::make_pair("culled" + plane, SMeshCheck::culled(topology, source.points, tree, planes[p].first, planes[p].second)));
+		results.push_back(std::make_pair("simplify" + plane, SMeshCheck::simplify(topology, source.points, planes[p].first, planes[p].second, 1e-3 * size)));
+	}
+	results.push_back(std::make_pair(std::string("slices"), SMeshCheck::slices(topology, source.points, center, SVec3(0.3, 1, 0.2), offsets)));
+
+	unsigned int failed = 0;
+	for (auto &result : results) {
+		printf("%-9s %9u faces  %-20s %s\n", shape.c_str(), topology.numFaces(), result.first.c_str(), result.second ? "ok" : "FAILED");
+		if (!result.second)
+			failed++;
+	}
+	return failed;
+}
+
+int main(int argc, char **argv) {
+	SBenchmarkOptions options;
+	if (!parseOptions(argc, argv, options)) {
+		printUsage(stderr);
+		return 1;
+	}
+
+	if (options.isHelp) {
+		printUsage(stdout);
+		return 0;
+	}
+
+	if (options.isCheck) {
+		if (!options.hasSizes)
+			options.sizes = { 1000, 20000 };
+
+		unsigned int failed = 0;
+		for (auto &shape : options.shapes)
+			for (auto &size : options.sizes)
+				failed += runChecks(options, shape, size);
+		return (failed == 0) ? 0 : 1;
+	}
+
+	FILE *file = stdout;
+	if (0 < options.output.size()) {
+		file = fopen(options.output.c_str(), "w");
+		if (file == NULL) {
+			fprintf(stderr, "cannot open %s\n", options.output.c_str());
+			return 1;
+		}
+	}
+
+	{
+		SBenchmarkReporter reporter(file, options.isCsv);
+		for (auto &shape : options.shapes)
+			for (auto &size : options.sizes)
+				runKernels(options, shape, size, reporter);
+	}
+
+	if (file != stdout)
+		fclose(file);
+
+	return 0;
+}
\ No newline at end of file